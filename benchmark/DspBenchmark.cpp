@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+    Benchmark for DSP modules
+
+    Every module is measured for each pair of block size and sample rate.
+    "time/sample" is the CPU time per sample, e.g. 3.2n means 3.2 [ns/sample].
+  ==============================================================================
+*/
+
+#include <benchmark/benchmark.h>
+#include <memory>
+
+#include "../src/dsp/Chorus.h"
+#include "../src/dsp/DspCommon.h"
+#include "../src/dsp/Envelope.h"
+#include "../src/dsp/Filter.h"
+#include "../src/dsp/Hpf.h"
+#include "../src/dsp/Lfo.h"
+#include "../src/dsp/MasterVolume.h"
+#include "../src/dsp/Oscillator.h"
+#include "../src/params/EnvelopeParamsMock.h"
+#include "../src/params/FilterParamsMock.h"
+#include "../src/params/HpfParamsMock.h"
+#include "../src/params/LfoParamsMock.h"
+#include "../src/params/MasterParamsMock.h"
+#include "../src/params/OscillatorParamsMock.h"
+#include "../tests/dsp/util/AudioBufferMock.h"
+#include "../tests/dsp/util/PositionInfoMock.h"
+#include "../tests/dsp/util/TestAudioBufferInput.h"
+
+//==============================================================================
+// Constants
+
+namespace
+{
+using onsen::flnum;
+
+constexpr int NUM_CHANNEL = 2;
+
+const std::vector<int64_t> BLOCK_SIZES = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+const std::vector<int64_t> SAMPLE_RATES = { 44100, 48000, 88200, 96000, 176400, 192000 };
+
+enum Waveform
+{
+    SIN,
+    SQUARE,
+    SAW,
+    SUB_SQUARE,
+    NOISE,
+    NUM_WAVEFORMS
+};
+
+void blockSizesAndSampleRates (benchmark::internal::Benchmark* b)
+{
+    b->ArgNames ({ "block", "rate" })->ArgsProduct ({ BLOCK_SIZES, SAMPLE_RATES });
+}
+
+int getBlockSize (const benchmark::State& state)
+{
+    return static_cast<int> (state.range (0));
+}
+
+double getSampleRate (const benchmark::State& state)
+{
+    return static_cast<double> (state.range (1));
+}
+
+// Reports the time per sample. Call it after the loop.
+void setTimePerSample (benchmark::State& state)
+{
+    state.counters["time/sample"] = benchmark::Counter (static_cast<double> (getBlockSize (state)),
+                                                        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+} // namespace
+
+//==============================================================================
+// Oscillator
+
+class OscillatorFixture : public benchmark::Fixture
+{
+public:
+    void SetUp (::benchmark::State& state) override
+    {
+        const auto waveform = static_cast<int> (state.range (2));
+        params.sinGain = waveform == SIN ? 1.0 : 0.0;
+        params.squareGain = waveform == SQUARE ? 1.0 : 0.0;
+        params.sawGain = waveform == SAW ? 1.0 : 0.0;
+        params.subSquareGain = waveform == SUB_SQUARE ? 1.0 : 0.0;
+        params.noiseGain = waveform == NOISE ? 1.0 : 0.0;
+        osc.setCurrentPlaybackSampleRate (getSampleRate (state));
+        osc.resetState();
+    }
+
+protected:
+    onsen::OscillatorParamsMock params { 1.0, 0.0, 0.0, 0.0, 0.0, 0.2 };
+    onsen::Oscillator osc { &params };
+};
+
+BENCHMARK_DEFINE_F (OscillatorFixture, oscillatorVal)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    // A4
+    const flnum angleDelta = 2.0 * onsen::pi * 440.0 / getSampleRate (state);
+    flnum angle = 0.0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < blockSize; i++)
+        {
+            benchmark::DoNotOptimize (osc.oscillatorVal (angle, 0.0));
+            angle += angleDelta;
+            if (angle > 2.0 * onsen::pi)
+                angle -= 2.0 * onsen::pi;
+        }
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (OscillatorFixture, oscillatorVal)
+    ->ArgNames ({ "block", "rate", "waveform" })
+    ->ArgsProduct ({ BLOCK_SIZES, SAMPLE_RATES, benchmark::CreateDenseRange (0, NUM_WAVEFORMS - 1, 1) });
+
+//==============================================================================
+// Envelope, LFO and Filter
+
+class ModulationFixture : public benchmark::Fixture
+{
+public:
+    void SetUp (::benchmark::State& state) override
+    {
+        const double sampleRate = getSampleRate (state);
+        env.setCurrentPlaybackSampleRate (sampleRate);
+        lfo.setCurrentPlaybackSampleRate (sampleRate);
+        lfo.setSamplesPerBlock (getBlockSize (state));
+        filter.setCurrentPlaybackSampleRate (sampleRate);
+        filter.resetBuffer();
+        env.noteOn();
+        lfo.noteOn();
+        lfo.renderLfo (0, getBlockSize (state));
+    }
+
+    void TearDown (::benchmark::State& state) override
+    {
+        env.noteOff();
+        lfo.noteOff();
+    }
+
+protected:
+    onsen::EnvelopeParamsMock envParams;
+    onsen::LfoParamsMock lfoParams { 0.5 /*[Hz]*/, 1.0 / 48.0 /*[bar]*/, 0.0 /*[rad]*/, 0.0001 /*no unit*/, false, 0.51, 0.52, 0.53 };
+    onsen::FilterParamsMock filterParams;
+    onsen::PositionInfoMock positionInfo;
+
+    onsen::Envelope env { &envParams };
+    onsen::Lfo lfo { &lfoParams, &positionInfo };
+    onsen::Filter filter { &filterParams, &env, &lfo };
+};
+
+BENCHMARK_DEFINE_F (ModulationFixture, envelopeUpdate)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < blockSize; i++)
+        {
+            env.update();
+            benchmark::DoNotOptimize (env.getLevel());
+        }
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (ModulationFixture, envelopeUpdate)->Apply (blockSizesAndSampleRates);
+
+BENCHMARK_DEFINE_F (ModulationFixture, renderLfo)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    for (auto _ : state)
+    {
+        lfo.renderLfo (0, blockSize);
+        benchmark::DoNotOptimize (lfo.getLevel (blockSize - 1));
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (ModulationFixture, renderLfo)->Apply (blockSizesAndSampleRates);
+
+BENCHMARK_DEFINE_F (ModulationFixture, renderLfoSync)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    for (auto _ : state)
+    {
+        lfo.renderLfoSync (0, blockSize);
+        benchmark::ClobberMemory();
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (ModulationFixture, renderLfoSync)->Apply (blockSizesAndSampleRates);
+
+BENCHMARK_DEFINE_F (ModulationFixture, filterProcess)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    flnum input = 0.3;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < blockSize; i++)
+        {
+            input = -input;
+            benchmark::DoNotOptimize (filter.process (input, i));
+        }
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (ModulationFixture, filterProcess)->Apply (blockSizesAndSampleRates);
+
+//==============================================================================
+// Effects which render an audio buffer in place
+
+class EffectFixture : public benchmark::Fixture
+{
+public:
+    void SetUp (::benchmark::State& state) override
+    {
+        const double sampleRate = getSampleRate (state);
+        audioBuffer = std::make_unique<onsen::AudioBufferMock> (NUM_CHANNEL, getBlockSize (state));
+        onsen::setTestInput1 (audioBuffer.get());
+        chorus.setCurrentPlaybackSampleRate (sampleRate);
+        hpf.setCurrentPlaybackSampleRate (sampleRate);
+        masterVolume.setCurrentPlaybackSampleRate (sampleRate);
+    }
+
+    void TearDown (::benchmark::State& state) override
+    {
+        audioBuffer.reset();
+    }
+
+protected:
+    onsen::HpfParamsMock hpfParams;
+    onsen::MasterParamsMock masterParams { true, 2.0, 0.0, 0.0, 0.0, 0.0, 0.5 };
+
+    onsen::Chorus chorus;
+    onsen::Hpf hpf { &hpfParams, NUM_CHANNEL };
+    onsen::MasterVolume masterVolume { &masterParams };
+    std::unique_ptr<onsen::AudioBufferMock> audioBuffer;
+};
+
+BENCHMARK_DEFINE_F (EffectFixture, chorusRender)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    for (auto _ : state)
+    {
+        chorus.render (audioBuffer.get(), 0, blockSize);
+        benchmark::ClobberMemory();
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (EffectFixture, chorusRender)->Apply (blockSizesAndSampleRates);
+
+BENCHMARK_DEFINE_F (EffectFixture, chorusEnsembleRender)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    chorus.setNumTaps (static_cast<int> (state.range (2)));
+    for (auto _ : state)
+    {
+        chorus.render (audioBuffer.get(), 0, blockSize);
+        benchmark::ClobberMemory();
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (EffectFixture, chorusEnsembleRender)
+    ->ArgNames ({ "block", "rate", "taps" })
+    ->ArgsProduct ({ BLOCK_SIZES, SAMPLE_RATES, benchmark::CreateDenseRange (2, onsen::Chorus::MAX_NUM_TAPS, 1) });
+
+BENCHMARK_DEFINE_F (EffectFixture, hpfRender)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    for (auto _ : state)
+    {
+        hpf.render (audioBuffer.get(), 0, blockSize);
+        benchmark::ClobberMemory();
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (EffectFixture, hpfRender)->Apply (blockSizesAndSampleRates);
+
+BENCHMARK_DEFINE_F (EffectFixture, masterVolumeRender)
+(benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    for (auto _ : state)
+    {
+        masterVolume.render (audioBuffer.get(), 0, blockSize);
+        benchmark::ClobberMemory();
+    }
+    setTimePerSample (state);
+}
+BENCHMARK_REGISTER_F (EffectFixture, masterVolumeRender)->Apply (blockSizesAndSampleRates);
+
+//==============================================================================
+// SmoothFlnum
+
+static void smoothFlnum (benchmark::State& state)
+{
+    const int blockSize = getBlockSize (state);
+    onsen::SmoothFlnum smoothed (0.0, 0.995);
+    smoothed.prepareToPlay (getSampleRate (state));
+    flnum target = 1.0;
+    for (auto _ : state)
+    {
+        // A new target every block like a parameter automation
+        target = -target;
+        smoothed.set (target);
+        for (int i = 0; i < blockSize; i++)
+        {
+            smoothed.update();
+            benchmark::DoNotOptimize (smoothed.get());
+        }
+    }
+    setTimePerSample (state);
+}
+BENCHMARK (smoothFlnum)->Apply (blockSizesAndSampleRates);
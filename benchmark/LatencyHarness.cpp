@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+    Block latency harness
+
+    Drives SynthEngine block by block like a host and records the wall time
+    of every block. Reports p50/p99/p99.9/max, a histogram and the rate of
+    blocks which missed their deadline (the duration of the block) as JSON.
+
+    Usage: Os251_LatencyHarness [--blocks <num blocks>] [--out <json file>]
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/synth/SynthEngine.h"
+#include "../tests/dsp/util/AudioBufferMock.h"
+#include "../tests/dsp/util/PositionInfoMock.h"
+#include "../tests/synth/SynthParamsMock.h"
+
+namespace
+{
+//==============================================================================
+// Constants
+
+const std::vector<int> BLOCK_SIZES = { 64, 128, 256, 512, 1024 };
+const std::vector<double> SAMPLE_RATES = { 44100.0, 48000.0, 96000.0 };
+constexpr int DEFAULT_NUM_BLOCKS = 1000;
+constexpr int NUM_CHANNEL = 2;
+constexpr int NUM_CHORD_NOTES = 8;
+constexpr int LOWEST_NOTE = 0x24;
+constexpr int VEL_100 = 0x64;
+
+// Histogram buckets are powers of two in [us]: [0, 1), [1, 2), [2, 4), ...
+constexpr int NUM_HISTOGRAM_BUCKETS = 18;
+
+// Events are triggered at the beginning of a block every N blocks
+constexpr int BURST_INTERVAL_BLOCKS = 16;
+constexpr int PRESET_SWITCH_INTERVAL_BLOCKS = 32;
+constexpr int SAMPLE_RATE_CHANGE_INTERVAL_BLOCKS = 64;
+
+enum class Scenario
+{
+    sustainedChord, // 8 voices are held
+    noteOnBurst, // All voices start at once and stop BURST_INTERVAL_BLOCKS / 2 blocks later
+    presetSwitch, // Every parameter changes at once like loading a preset
+    sampleRateChange // The sample rate is doubled and restored. It clears the chorus' delay line without allocating.
+};
+
+const char* toString (Scenario scenario)
+{
+    switch (scenario)
+    {
+        case Scenario::sustainedChord:
+            return "sustainedChord";
+        case Scenario::noteOnBurst:
+            return "noteOnBurst";
+        case Scenario::presetSwitch:
+            return "presetSwitch";
+        case Scenario::sampleRateChange:
+            return "sampleRateChange";
+    }
+    return "";
+}
+
+//==============================================================================
+struct Result
+{
+    Scenario scenario;
+    int blockSize;
+    double sampleRate;
+    std::vector<double> blockTimesUs;
+    int numDeadlineMisses;
+    double totalAudioUs;
+};
+
+double percentile (const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    const auto idx = static_cast<size_t> (p * static_cast<double> (sorted.size() - 1) + 0.5);
+    return sorted[std::min (idx, sorted.size() - 1)];
+}
+
+//==============================================================================
+class Harness
+{
+public:
+    Harness (int _blockSize, double _sampleRate)
+        : blockSize (_blockSize),
+          sampleRate (_sampleRate),
+          audioBuffer (NUM_CHANNEL, static_cast<size_t> (_blockSize))
+    {
+        // Like Os251AudioProcessor::prepareToPlay()
+        synth.setCurrentPlaybackSampleRate (sampleRate);
+        synth.setNumberOfVoices (onsen::SynthEngine::getMaxNumVoices());
+    }
+
+    Result run (Scenario scenario, int numBlocks)
+    {
+        Result result { scenario, blockSize, sampleRate, {}, 0, 0.0 };
+        result.blockTimesUs.reserve (static_cast<size_t> (numBlocks));
+
+        if (scenario != Scenario::noteOnBurst)
+            playChord (NUM_CHORD_NOTES);
+
+        double currentSampleRate = sampleRate;
+        for (int block = 0; block < numBlocks; block++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            switch (scenario)
+            {
+                case Scenario::sustainedChord:
+                    break;
+                case Scenario::noteOnBurst:
+                    if (block % BURST_INTERVAL_BLOCKS == 0)
+                        playChord (onsen::SynthEngine::getMaxNumVoices());
+                    else if (block % BURST_INTERVAL_BLOCKS == BURST_INTERVAL_BLOCKS / 2)
+                        synth.allNoteOff();
+                    break;
+                case Scenario::presetSwitch:
+                    if (block % PRESET_SWITCH_INTERVAL_BLOCKS == 0)
+                        switchPreset();
+                    break;
+                case Scenario::sampleRateChange:
+                    if (block % SAMPLE_RATE_CHANGE_INTERVAL_BLOCKS == 0)
+                    {
+                        currentSampleRate = currentSampleRate == sampleRate ? sampleRate * 2.0 : sampleRate;
+                        synth.setCurrentPlaybackSampleRate (currentSampleRate);
+                    }
+                    break;
+            }
+            render();
+            const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+            const double deadlineUs = blockSize / currentSampleRate * 1.0e6;
+            result.blockTimesUs.push_back (elapsed.count());
+            result.totalAudioUs += deadlineUs;
+            if (elapsed.count() > deadlineUs)
+                result.numDeadlineMisses++;
+        }
+        return result;
+    }
+
+private:
+    const int blockSize;
+    const double sampleRate;
+
+    onsen::SynthParamsMockValues synthParamsMockValues {};
+    std::shared_ptr<onsen::SynthParams> synthParams { synthParamsMockValues.getSynthParams() };
+    onsen::PositionInfoMock positionInfo {};
+    onsen::Lfo lfo { synthParams->lfo(), &positionInfo };
+    std::vector<std::shared_ptr<onsen::ISynthVoice>> voices { onsen::FancySynthVoice::buildVoices (onsen::SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo) };
+    onsen::SynthEngine synth { synthParams.get(), &positionInfo, &lfo, voices };
+    onsen::AudioBufferMock audioBuffer;
+    std::mt19937 randomEngine { 251 };
+
+    void render()
+    {
+        for (int ch = 0; ch < NUM_CHANNEL; ch++)
+            std::fill_n (audioBuffer.getWritePointer (ch), blockSize, 0.0f);
+        synth.renderNextBlock (&audioBuffer, 0, blockSize);
+    }
+
+    void playChord (int numNotes)
+    {
+        for (int i = 0; i < numNotes; i++)
+            synth.noteOn (LOWEST_NOTE + i * 2, VEL_100);
+    }
+
+    // What Os251AudioProcessor does when the host restores a state
+    void switchPreset()
+    {
+        std::uniform_real_distribution<onsen::flnum> dist (0.0, 1.0);
+        for (auto& param : synthParamsMockValues.params)
+            param = dist (randomEngine);
+        synthParams->parameterChanged();
+    }
+};
+
+//==============================================================================
+void writeJson (std::ostream& out, const std::vector<Result>& results)
+{
+    out << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto& r = results[i];
+        auto sorted = r.blockTimesUs;
+        std::sort (sorted.begin(), sorted.end());
+
+        double totalUs = 0.0;
+        std::vector<int> histogram (NUM_HISTOGRAM_BUCKETS, 0);
+        for (const auto t : sorted)
+        {
+            totalUs += t;
+            int bucket = 0;
+            while (bucket < NUM_HISTOGRAM_BUCKETS - 1 && t >= static_cast<double> (1 << bucket))
+                bucket++;
+            histogram[bucket]++;
+        }
+        const auto numBlocks = static_cast<double> (sorted.size());
+
+        out << "    {\n"
+            << "      \"scenario\": \"" << toString (r.scenario) << "\",\n"
+            << "      \"blockSize\": " << r.blockSize << ",\n"
+            << "      \"sampleRate\": " << r.sampleRate << ",\n"
+            << "      \"numBlocks\": " << sorted.size() << ",\n"
+            << "      \"p50Us\": " << percentile (sorted, 0.5) << ",\n"
+            << "      \"p99Us\": " << percentile (sorted, 0.99) << ",\n"
+            << "      \"p999Us\": " << percentile (sorted, 0.999) << ",\n"
+            << "      \"maxUs\": " << (sorted.empty() ? 0.0 : sorted.back()) << ",\n"
+            << "      \"deadlineMissRate\": " << (numBlocks > 0 ? r.numDeadlineMisses / numBlocks : 0.0) << ",\n"
+            << "      \"realtimeFactor\": " << (totalUs > 0.0 ? r.totalAudioUs / totalUs : 0.0) << ",\n"
+            << "      \"histogramUpperBoundsUs\": [";
+        for (int b = 0; b < NUM_HISTOGRAM_BUCKETS; b++)
+            out << (b ? ", " : "") << (b == NUM_HISTOGRAM_BUCKETS - 1 ? -1 : (1 << b));
+        out << "],\n      \"histogram\": [";
+        for (int b = 0; b < NUM_HISTOGRAM_BUCKETS; b++)
+            out << (b ? ", " : "") << histogram[b];
+        out << "]\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+} // namespace
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    int numBlocks = DEFAULT_NUM_BLOCKS;
+    std::string outPath;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp (argv[i], "--blocks") == 0 && i + 1 < argc)
+            numBlocks = std::max (1, std::atoi (argv[++i]));
+        else if (std::strcmp (argv[i], "--out") == 0 && i + 1 < argc)
+            outPath = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--blocks <num blocks>] [--out <json file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const auto scenario : { Scenario::sustainedChord, Scenario::noteOnBurst, Scenario::presetSwitch, Scenario::sampleRateChange })
+    {
+        for (const auto sampleRate : SAMPLE_RATES)
+        {
+            for (const auto blockSize : BLOCK_SIZES)
+            {
+                Harness harness (blockSize, sampleRate);
+                results.push_back (harness.run (scenario, numBlocks));
+            }
+        }
+    }
+
+    if (outPath.empty())
+    {
+        writeJson (std::cout, results);
+        return 0;
+    }
+    std::ofstream file (outPath);
+    if (! file)
+    {
+        std::cerr << "Failed to open " << outPath << std::endl;
+        return 1;
+    }
+    writeJson (file, results);
+    return 0;
+}
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+    Benchmark for dense MIDI event streams
+
+    JuceSynthEngineAdapter splits a block at every event, so dense streams
+    render many short segments. "segments" is the number of segments per block
+    and "time/sample" is the CPU time per sample, e.g. 3.2n means 3.2 [ns/sample].
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <set>
+
+#include "../src/adapters/JuceAudioBuffer.h"
+#include "../src/adapters/JuceSynthEngineAdapter.h"
+#include "../tests/dsp/util/PositionInfoMock.h"
+#include "../tests/synth/SynthParamsMock.h"
+
+//==============================================================================
+// Constants
+
+namespace
+{
+constexpr double SAMPLE_RATE = 48000.0;
+constexpr int SAMPLES_PER_BLOCK = 512;
+constexpr int NUM_CHANNEL = 2;
+constexpr int MIDI_CHANNEL = 1;
+constexpr int NUM_CHORD_NOTES = 8;
+constexpr int LOWEST_NOTE = 0x24;
+constexpr juce::uint8 VEL_100 = 0x64;
+constexpr int SUSTAIN_PEDAL = 64;
+constexpr int SOSTENUTO_PEDAL = 66;
+
+// Intervals between events in samples
+const std::vector<int64_t> EVENT_INTERVALS = { 1, 2, 4, 8, 16, 32, 64, 128 };
+} // namespace
+
+//==============================================================================
+
+class MidiFixture : public benchmark::Fixture
+{
+public:
+    void SetUp (::benchmark::State& state) override
+    {
+        synthEngineAdapter.prepareToPlay (SAMPLES_PER_BLOCK, SAMPLE_RATE);
+        synthEngineAdapter.changeNumberOfVoices (onsen::SynthEngine::getMaxNumVoices());
+        synthEngineAdapter.setControlGranularity (1);
+        inputMidiBuffer.clear();
+    }
+
+    void TearDown (::benchmark::State& state) override
+    {
+        synth.setSustainPedalDown (false);
+        synth.setSostenutoPedalDown (false);
+        synth.allNoteOff();
+    }
+
+    // Notes which keep sounding during the benchmark
+    void playChord()
+    {
+        for (int i = 0; i < NUM_CHORD_NOTES; i++)
+            synth.noteOn (LOWEST_NOTE + i * 2, VEL_100);
+    }
+
+    void render (benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            outputAudio.clear();
+            onsen::JuceAudioBuffer audioBuffer (&outputAudio);
+            synthEngineAdapter.renderNextBlock (&audioBuffer, inputMidiBuffer, 0, SAMPLES_PER_BLOCK);
+            benchmark::ClobberMemory();
+        }
+
+        std::set<int> eventPositions;
+        for (const auto metadata : inputMidiBuffer)
+            eventPositions.insert (metadata.samplePosition);
+        const auto numSegments = eventPositions.size() + (eventPositions.count (0) == 0 ? 1 : 0);
+        state.counters["segments"] = static_cast<double> (numSegments);
+        state.counters["time/sample"] = benchmark::Counter (SAMPLES_PER_BLOCK,
+                                                            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+
+    static int getEventInterval (const benchmark::State& state)
+    {
+        return static_cast<int> (state.range (0));
+    }
+
+    void setControlGranularity (int numSamples)
+    {
+        synthEngineAdapter.setControlGranularity (numSamples);
+    }
+
+protected:
+    juce::MidiBuffer inputMidiBuffer;
+
+private:
+    onsen::SynthParamsMockValues synthParamsMockValues {};
+    std::shared_ptr<onsen::SynthParams> synthParams { synthParamsMockValues.getSynthParams() };
+    onsen::PositionInfoMock positionInfo {};
+    onsen::Lfo lfo { synthParams->lfo(), &positionInfo };
+    std::vector<std::shared_ptr<onsen::ISynthVoice>> voices { onsen::FancySynthVoice::buildVoices (onsen::SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo) };
+    onsen::SynthEngine synth { synthParams.get(), &positionInfo, &lfo, voices };
+    onsen::JuceSynthEngineAdapter synthEngineAdapter { synth };
+    juce::AudioBuffer<float> outputAudio { NUM_CHANNEL, SAMPLES_PER_BLOCK };
+};
+
+// A controller rig sends the pitch wheel continuously
+BENCHMARK_DEFINE_F (MidiFixture, pitchWheelStream)
+(benchmark::State& state)
+{
+    playChord();
+    const int interval = getEventInterval (state);
+    for (int i = 0; i < SAMPLES_PER_BLOCK; i += interval)
+    {
+        // A sine-like sweep around the centre
+        const int value = 8192 + static_cast<int> (4096.0 * std::sin (2.0 * juce::MathConstants<double>::pi * i / SAMPLES_PER_BLOCK));
+        inputMidiBuffer.addEvent (juce::MidiMessage::pitchWheel (MIDI_CHANNEL, value), i);
+    }
+    render (state);
+}
+BENCHMARK_REGISTER_F (MidiFixture, pitchWheelStream)->ArgName ("interval")->ArgsProduct ({ EVENT_INTERVALS });
+
+// The same stream rendered with JuceSynthEngineAdapter::setControlGranularity()
+BENCHMARK_DEFINE_F (MidiFixture, pitchWheelStreamWithControlGranularity)
+(benchmark::State& state)
+{
+    playChord();
+    const int interval = getEventInterval (state);
+    const int granularity = static_cast<int> (state.range (1));
+    setControlGranularity (granularity);
+    for (int i = 0; i < SAMPLES_PER_BLOCK; i += interval)
+    {
+        const int value = 8192 + static_cast<int> (4096.0 * std::sin (2.0 * juce::MathConstants<double>::pi * i / SAMPLES_PER_BLOCK));
+        inputMidiBuffer.addEvent (juce::MidiMessage::pitchWheel (MIDI_CHANNEL, value), i);
+    }
+    render (state);
+    // Pitch-wheel values are applied once per granule
+    state.counters["segments"] = static_cast<double> ((SAMPLES_PER_BLOCK + std::max (interval, granularity) - 1) / std::max (interval, granularity));
+}
+BENCHMARK_REGISTER_F (MidiFixture, pitchWheelStreamWithControlGranularity)
+    ->ArgNames ({ "interval", "granularity" })
+    ->ArgsProduct ({ { 1, 2, 4, 16 }, { 1, 8, 16, 32 } });
+
+// Sustain and sostenuto pedals are pressed and released alternately
+BENCHMARK_DEFINE_F (MidiFixture, pedalToggle)
+(benchmark::State& state)
+{
+    playChord();
+    const int interval = getEventInterval (state);
+    bool isDown = true;
+    for (int i = 0; i < SAMPLES_PER_BLOCK; i += interval)
+    {
+        const int pedal = (i / interval) % 4 < 2 ? SUSTAIN_PEDAL : SOSTENUTO_PEDAL;
+        inputMidiBuffer.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, pedal, isDown ? 127 : 0), i);
+        isDown = ! isDown;
+    }
+    render (state);
+}
+BENCHMARK_REGISTER_F (MidiFixture, pedalToggle)->ArgName ("interval")->ArgsProduct ({ EVENT_INTERVALS });
+
+// Each note is released when the next one starts
+BENCHMARK_DEFINE_F (MidiFixture, arpeggio)
+(benchmark::State& state)
+{
+    const int interval = getEventInterval (state);
+    int prevNote = -1;
+    for (int i = 0; i < SAMPLES_PER_BLOCK; i += interval)
+    {
+        const int note = LOWEST_NOTE + ((i / interval) % 24) * 2;
+        if (prevNote >= 0)
+            inputMidiBuffer.addEvent (juce::MidiMessage::noteOff (MIDI_CHANNEL, prevNote), i);
+        inputMidiBuffer.addEvent (juce::MidiMessage::noteOn (MIDI_CHANNEL, note, VEL_100), i);
+        prevNote = note;
+    }
+    inputMidiBuffer.addEvent (juce::MidiMessage::noteOff (MIDI_CHANNEL, prevNote), SAMPLES_PER_BLOCK - 1);
+    render (state);
+}
+BENCHMARK_REGISTER_F (MidiFixture, arpeggio)->ArgName ("interval")->ArgsProduct ({ EVENT_INTERVALS });
+
+// All 128 notes start at once and stop in the middle of the block.
+// Every note is spread over `interval` samples.
+BENCHMARK_DEFINE_F (MidiFixture, noteCluster)
+(benchmark::State& state)
+{
+    const int interval = getEventInterval (state);
+    constexpr int numNotes = 128;
+    for (int note = 0; note < numNotes; note++)
+    {
+        const int onPosition = std::min (note * interval / numNotes, SAMPLES_PER_BLOCK / 2 - 1);
+        inputMidiBuffer.addEvent (juce::MidiMessage::noteOn (MIDI_CHANNEL, note, VEL_100), onPosition);
+        inputMidiBuffer.addEvent (juce::MidiMessage::noteOff (MIDI_CHANNEL, note), SAMPLES_PER_BLOCK / 2 + onPosition);
+    }
+    render (state);
+}
+BENCHMARK_REGISTER_F (MidiFixture, noteCluster)->ArgName ("spread")->Arg (1)->Arg (128)->Arg (256);
@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+    Benchmark for parameter automation
+
+    Every parameter is automated like a host does, and what
+    Os251AudioProcessor::parameterChanged() does is measured on the audio thread.
+    "allocs" is the number of allocations per iteration. It runs as Os251_ParamBenchmark
+    because the allocation counter would slow down the other benchmarks.
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+
+#include "../src/synth/SynthEngine.h"
+#include "../tests/dsp/util/AudioBufferMock.h"
+#include "../tests/dsp/util/PositionInfoMock.h"
+#include "../tests/synth/SynthParamsMock.h"
+#include "../tests/util/AllocationCounter.h"
+
+//==============================================================================
+// Constants
+
+namespace
+{
+constexpr double SAMPLE_RATE = 44100.0;
+constexpr int MAX_SAMPLES_PER_BLOCK = 1024;
+constexpr int NUM_CHANNEL = 2;
+constexpr int NUM_CHORD_NOTES = 8;
+constexpr int LOWEST_NOTE = 0x24;
+constexpr int VEL_100 = 0x64;
+// Automated values go up and down in this step
+constexpr onsen::flnum AUTOMATION_STEP = 1.0 / 128.0;
+
+void setAllocationCounter (benchmark::State& state, size_t numAllocationsBefore)
+{
+    state.counters["allocs"] = benchmark::Counter (
+        static_cast<double> (onsen::AllocationCounter::getNumAllocations() - numAllocationsBefore),
+        benchmark::Counter::kAvgIterations);
+}
+} // namespace
+
+//==============================================================================
+
+class ParamFixture : public benchmark::Fixture
+{
+public:
+    void SetUp (::benchmark::State& state) override
+    {
+        synth.setCurrentPlaybackSampleRate (SAMPLE_RATE);
+        synth.setNumberOfVoices (NUM_CHORD_NOTES);
+        for (int i = 0; i < NUM_CHORD_NOTES; i++)
+            synth.noteOn (LOWEST_NOTE + i * 2, VEL_100);
+    }
+
+    void TearDown (::benchmark::State& state) override
+    {
+        synth.allNoteOff();
+    }
+
+    // Sets the next automated value to every parameter.
+    // A host notifies each change, so the listener is called for each parameter.
+    void automateAllParams()
+    {
+        automationValue += AUTOMATION_STEP;
+        if (automationValue > 1.0)
+            automationValue -= 1.0;
+        for (auto& param : synthParamsMockValues.params)
+        {
+            param.store (automationValue);
+            synthParams->parameterChanged();
+        }
+    }
+
+    void render (int startSample, int numSamples)
+    {
+        synth.renderNextBlock (&audioBuffer, startSample, numSamples);
+    }
+
+    void clearAudioBuffer()
+    {
+        for (int ch = 0; ch < NUM_CHANNEL; ch++)
+            std::fill_n (audioBuffer.getWritePointer (ch), MAX_SAMPLES_PER_BLOCK, 0.0f);
+    }
+
+protected:
+    onsen::SynthParamsMockValues synthParamsMockValues {};
+    std::shared_ptr<onsen::SynthParams> synthParams { synthParamsMockValues.getSynthParams() };
+
+private:
+    onsen::PositionInfoMock positionInfo {};
+    onsen::Lfo lfo { synthParams->lfo(), &positionInfo };
+    std::vector<std::shared_ptr<onsen::ISynthVoice>> voices { onsen::FancySynthVoice::buildVoices (onsen::SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo) };
+    onsen::SynthEngine synth { synthParams.get(), &positionInfo, &lfo, voices };
+    onsen::AudioBufferMock audioBuffer { NUM_CHANNEL, MAX_SAMPLES_PER_BLOCK };
+    onsen::flnum automationValue = 0.0;
+};
+
+// Only the listener
+BENCHMARK_F (ParamFixture, parameterChanged)
+(benchmark::State& state)
+{
+    const auto numAllocationsBefore = onsen::AllocationCounter::getNumAllocations();
+    for (auto _ : state)
+    {
+        synthParams->parameterChanged();
+        benchmark::ClobberMemory();
+    }
+    setAllocationCounter (state, numAllocationsBefore);
+}
+
+// Every parameter changes once per block
+BENCHMARK_DEFINE_F (ParamFixture, automateEveryBlock)
+(benchmark::State& state)
+{
+    const int blockSize = static_cast<int> (state.range (0));
+    const auto numAllocationsBefore = onsen::AllocationCounter::getNumAllocations();
+    for (auto _ : state)
+    {
+        clearAudioBuffer();
+        automateAllParams();
+        render (0, blockSize);
+        benchmark::ClobberMemory();
+    }
+    setAllocationCounter (state, numAllocationsBefore);
+    state.SetItemsProcessed (state.iterations() * blockSize);
+}
+BENCHMARK_REGISTER_F (ParamFixture, automateEveryBlock)->ArgName ("block")->RangeMultiplier (2)->Range (64, MAX_SAMPLES_PER_BLOCK);
+
+// Every parameter changes at every sample, and the block is split at every sample
+BENCHMARK_DEFINE_F (ParamFixture, automateEverySample)
+(benchmark::State& state)
+{
+    const int blockSize = static_cast<int> (state.range (0));
+    const auto numAllocationsBefore = onsen::AllocationCounter::getNumAllocations();
+    for (auto _ : state)
+    {
+        clearAudioBuffer();
+        for (int i = 0; i < blockSize; i++)
+        {
+            automateAllParams();
+            render (i, 1);
+        }
+        benchmark::ClobberMemory();
+    }
+    setAllocationCounter (state, numAllocationsBefore);
+    state.SetItemsProcessed (state.iterations() * blockSize);
+}
+BENCHMARK_REGISTER_F (ParamFixture, automateEverySample)->ArgName ("block")->RangeMultiplier (2)->Range (64, MAX_SAMPLES_PER_BLOCK);
+
+// What a host calls to draw automation lanes. An item is a conversion.
+BENCHMARK_F (ParamFixture, valueToString)
+(benchmark::State& state)
+{
+    const auto paramMetas = synthParams->getParamMetaList();
+    const auto numAllocationsBefore = onsen::AllocationCounter::getNumAllocations();
+    onsen::flnum value = 0.0;
+    for (auto _ : state)
+    {
+        for (const auto& meta : paramMetas)
+            benchmark::DoNotOptimize (meta.valueToString (value));
+        value += AUTOMATION_STEP;
+        if (value > 1.0)
+            value -= 1.0;
+    }
+    setAllocationCounter (state, numAllocationsBefore);
+    state.SetItemsProcessed (state.iterations() * static_cast<int64_t> (paramMetas.size()));
+}
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+    Benchmark for polyphony and unison
+
+    Renders a chord held by the sustain pedal with 1 to the max number of voices.
+    "time/voice" is the CPU time of a block per active voice and
+    "marginal/voice" is the same without the cost of an idle engine
+    (LFO, HPF, chorus and master volume).
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+#include "../src/synth/SynthEngine.h"
+#include "../tests/dsp/util/AudioBufferMock.h"
+#include "../tests/dsp/util/PositionInfoMock.h"
+#include "../tests/synth/SynthParamsMock.h"
+
+//==============================================================================
+// Constants
+
+namespace
+{
+constexpr double SAMPLE_RATE = 44100.0;
+constexpr int SAMPLES_PER_BLOCK = 512;
+constexpr int NUM_CHANNEL = 2;
+constexpr int NUM_IDLE_BLOCKS = 256;
+
+// Notes of the chord are a minor third apart from C1
+constexpr int LOWEST_NOTE = 0x24;
+constexpr int NOTE_INTERVAL = 3;
+constexpr int VEL_100 = 0x64;
+
+enum Mode
+{
+    POLY,
+    UNISON
+};
+} // namespace
+
+//==============================================================================
+
+class PolyphonyFixture : public benchmark::Fixture
+{
+public:
+    void SetUp (::benchmark::State& state) override
+    {
+        numVoices = static_cast<int> (state.range (0));
+        const bool isUnison = state.range (1) == UNISON;
+
+        synth.setCurrentPlaybackSampleRate (SAMPLE_RATE);
+        synth.setNumberOfVoices (numVoices);
+        synth.setIsUnison (isUnison);
+        idleBlockSec = measureIdleBlockSec();
+
+        // Every note keeps sounding after its note off
+        synth.setSustainPedalDown (true);
+        const int numNotes = isUnison ? 1 : numVoices;
+        for (int i = 0; i < numNotes; i++)
+        {
+            const int note = LOWEST_NOTE + i * NOTE_INTERVAL;
+            synth.noteOn (note, VEL_100);
+            synth.noteOff (note);
+        }
+    }
+
+    void TearDown (::benchmark::State& state) override
+    {
+        synth.setSustainPedalDown (false);
+        synth.allNoteOff();
+    }
+
+    void render()
+    {
+        for (int ch = 0; ch < NUM_CHANNEL; ch++)
+            std::fill_n (audioBuffer.getWritePointer (ch), SAMPLES_PER_BLOCK, 0.0f);
+        synth.renderNextBlock (&audioBuffer, 0, SAMPLES_PER_BLOCK);
+    }
+
+    void setCounters (benchmark::State& state, double elapsedSec)
+    {
+        const double blockSec = elapsedSec / static_cast<double> (state.iterations());
+        state.counters["time/voice"] = blockSec / numVoices;
+        state.counters["marginal/voice"] = std::max (0.0, blockSec - idleBlockSec) / numVoices;
+    }
+
+private:
+    onsen::SynthParamsMockValues synthParamsMockValues {};
+    std::shared_ptr<onsen::SynthParams> synthParams { synthParamsMockValues.getSynthParams() };
+    onsen::PositionInfoMock positionInfo {};
+    onsen::Lfo lfo { synthParams->lfo(), &positionInfo };
+    std::vector<std::shared_ptr<onsen::ISynthVoice>> voices { onsen::FancySynthVoice::buildVoices (onsen::SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo) };
+    onsen::SynthEngine synth { synthParams.get(), &positionInfo, &lfo, voices };
+    onsen::AudioBufferMock audioBuffer { NUM_CHANNEL, SAMPLES_PER_BLOCK };
+
+    int numVoices = 1;
+    double idleBlockSec = 0.0;
+
+    // The cost of a block without any sounding voice
+    double measureIdleBlockSec()
+    {
+        render(); // Warm up
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NUM_IDLE_BLOCKS; i++)
+            render();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / NUM_IDLE_BLOCKS;
+    }
+};
+
+BENCHMARK_DEFINE_F (PolyphonyFixture, heldChord)
+(benchmark::State& state)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (auto _ : state)
+    {
+        render();
+        benchmark::ClobberMemory();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    setCounters (state, elapsed.count());
+}
+BENCHMARK_REGISTER_F (PolyphonyFixture, heldChord)
+    ->ArgNames ({ "voices", "unison" })
+    ->ArgsProduct ({ benchmark::CreateDenseRange (1, onsen::SynthEngine::getMaxNumVoices(), 1), { POLY, UNISON } });
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+    Benchmark for preset manager
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <benchmark/benchmark.h>
+
+#include "../src/services/PresetManager.h"
+#include "../src/services/TmpFileManager.h"
+#include "../tests/services/AudioProcessorStateMock.h"
+
+//==============================================================================
+
+class PresetManagerFixture : public benchmark::Fixture
+{
+public:
+    void SetUp (::benchmark::State& state) override
+    {
+        // Presets are restored only by the first instance like a real session
+        presetDir.deleteRecursively();
+        onsen::AudioProcessorStateMock processorState;
+        onsen::PresetManager presetManager (&processorState, presetDir);
+        presetManager.scanPresets();
+    }
+
+    void TearDown (::benchmark::State& state) override
+    {
+        presetDir.deleteRecursively();
+    }
+
+protected:
+    const juce::File presetDir { onsen::TmpFileManager::getTmpDir().getChildFile ("preset_benchmark") };
+};
+
+// What Os251AudioProcessor's constructor does with presets
+BENCHMARK_F (PresetManagerFixture, construct)
+(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        onsen::AudioProcessorStateMock processorState;
+        onsen::PresetManager presetManager (&processorState, presetDir);
+        presetManager.loadPreset (presetManager.getDefaultPresetFile());
+    }
+}
+
+// What the editor does when it's opened
+BENCHMARK_F (PresetManagerFixture, scanPresets)
+(benchmark::State& state)
+{
+    onsen::AudioProcessorStateMock processorState;
+    onsen::PresetManager presetManager (&processorState, presetDir);
+    for (auto _ : state)
+    {
+        presetManager.scanPresets();
+    }
+}
+
+// A new instance scans presets for the first time
+BENCHMARK_F (PresetManagerFixture, constructAndScanPresets)
+(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        onsen::AudioProcessorStateMock processorState;
+        onsen::PresetManager presetManager (&processorState, presetDir);
+        presetManager.loadPreset (presetManager.getDefaultPresetFile());
+        presetManager.scanPresets();
+    }
+}
@@ -18,6 +18,7 @@ Os251AudioProcessorEditor::Os251AudioProcessorEditor (Os251AudioProcessor& proc,
       valueTreeState (vts),
       presetManagerView (presetManager),
       clippingIndicatorView (_synthUi),
+      dspLoadView (_synthUi),
       buttonParamLaf()
 {
     auto& processorParams = audioProcessor.getParameters();
@@ -33,6 +34,7 @@ Os251AudioProcessorEditor::Os251AudioProcessorEditor (Os251AudioProcessor& proc,
     addAndMakeVisible (presetManagerView);
 
     addAndMakeVisible (clippingIndicatorView);
+    addAndMakeVisible (dspLoadView);
 
     for (const auto& p : paramLayout)
     {
@@ -99,6 +101,8 @@ void Os251AudioProcessorEditor::resized()
 {
     constexpr int clippingIndicatorViewWidth = 100;
     presetManagerView.setBounds (400, headerContentsMarginY, 360, headerHeight - headerContentsMarginY);
+    // Between the synth name and the preset manager
+    dspLoadView.setBounds (130, headerContentsMarginY, 260, headerHeight - headerContentsMarginY);
 
     for (int i = 0; i < paramLayout.size(); i++)
     {
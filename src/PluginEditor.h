@@ -12,6 +12,7 @@
 #include "PluginProcessor.h"
 #include "views/ButtonParamLookAndFeel.h"
 #include "views/ClippingIndicatorView.h"
+#include "views/DspLoadView.h"
 #include "views/PresetManagerView.h"
 #include <JuceHeader.h>
 #include <atomic>
@@ -55,6 +56,7 @@ private:
 
     onsen::PresetManagerView presetManagerView;
     onsen::ClippingIndicatorView clippingIndicatorView;
+    onsen::DspLoadView dspLoadView;
 
     std::unordered_map<juce::String, juce::AudioProcessorParameter*> parameterById;
 
@@ -31,7 +31,9 @@ Os251AudioProcessor::Os251AudioProcessor()
       voices (onsen::FancySynthVoice::buildVoices (onsen::SynthEngine::getMaxNumVoices(), &synthParams, &lfo)),
       synth (&synthParams, &jucePositionInfo, &lfo, voices),
       synthEngineAdapter (synth),
-      synthUi (synth),
+      dspLoadMeter(),
+      qualityGovernor(),
+      synthUi (synth, dspLoadMeter),
       processorState (apvts),
       presetManager (
           &processorState,
@@ -117,7 +119,7 @@ bool Os251AudioProcessor::isMidiEffect() const
 
 double Os251AudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return synth.getTailLengthSeconds();
 }
 
 int Os251AudioProcessor::getNumPrograms()
@@ -151,6 +153,7 @@ void Os251AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     // initialisation that you need..
     synthEngineAdapter.prepareToPlay (samplesPerBlock, sampleRate);
     synthParams.prepareToPlay (samplesPerBlock, sampleRate);
+    dspLoadMeter.setCurrentPlaybackSampleRate (sampleRate);
 }
 
 void Os251AudioProcessor::releaseResources()
@@ -186,6 +189,8 @@ bool Os251AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
 
 void Os251AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    dspLoadMeter.beginBlock();
+
     // Host information
     auto playHead = getPlayHead();
     if (playHead)
@@ -224,6 +229,26 @@ void Os251AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
 
     onsen::JuceAudioBuffer audioBuffer (&buffer);
     synthEngineAdapter.renderNextBlock (&audioBuffer, midiMessages, 0, buffer.getNumSamples());
+
+    dspLoadMeter.endBlock (buffer.getNumSamples(), synth.getNumActiveVoices());
+    // Offline rendering has no deadline
+    if (isNonRealtime())
+    {
+        qualityGovernor.reset();
+        updateQualityLevel (onsen::QualityLevel::full);
+    }
+    else
+    {
+        updateQualityLevel (qualityGovernor.update (dspLoadMeter.getLastLoad()));
+    }
+}
+
+void Os251AudioProcessor::updateQualityLevel (onsen::QualityLevel level)
+{
+    if (level == synth.getQualityLevel())
+        return;
+    synth.setQualityLevel (level);
+    synthEngineAdapter.setControlGranularity (level >= onsen::QualityLevel::coarseControl ? coarseControlGranularity : 1);
 }
 
 //==============================================================================
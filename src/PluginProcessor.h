@@ -12,6 +12,8 @@
 #include "adapters/JucePositionInfo.h"
 #include "adapters/JuceSynthEngineAdapter.h"
 #include "services/PresetManager.h"
+#include "synth/DspLoadMeter.h"
+#include "synth/QualityGovernor.h"
 #include "synth/SynthUi.h"
 #include "views/GlobalLookAndFeel.h"
 #include <JuceHeader.h>
@@ -69,6 +71,8 @@ private:
     std::vector<std::shared_ptr<onsen::ISynthVoice>> voices;
     onsen::SynthEngine synth;
     onsen::JuceSynthEngineAdapter synthEngineAdapter;
+    onsen::DspLoadMeter dspLoadMeter;
+    onsen::QualityGovernor qualityGovernor;
     onsen::SynthUi synthUi;
     onsen::JuceAudioProcessorState processorState;
     onsen::PresetManager presetManager;
@@ -76,6 +80,10 @@ private:
 
     //==============================================================================
     void parameterChanged (const juce::String& parameterID, float newValue) override;
+    // Applies a level of QualityGovernor to the engine and the adapter
+    void updateQualityLevel (onsen::QualityLevel level);
+    // Samples per control granule at QualityLevel::coarseControl
+    static constexpr int coarseControlGranularity = 32;
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Os251AudioProcessor)
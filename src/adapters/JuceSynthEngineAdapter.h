@@ -23,16 +23,21 @@ public:
     {
     }
 
-    void prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+    // SynthEngine renders blocks of any size, so samplesPerBlockExpected is only a hint
+    void prepareToPlay (int /*samplesPerBlockExpected*/, double sampleRate)
     {
         synth.setCurrentPlaybackSampleRate (sampleRate);
-        synth.setSamplesPerBlock (samplesPerBlockExpected);
     }
 
     void releaseResources() {}
 
     void renderNextBlock (IAudioBuffer* outputAudio, const juce::MidiBuffer& inputMidi, int startSample, int numSamples)
     {
+        if (controlGranularity > 1 && inputMidi.getNumEvents())
+        {
+            renderNextBlockWithControlGranularity (outputAudio, inputMidi, startSample, numSamples);
+            return;
+        }
         if (! inputMidi.getNumEvents())
         {
             synth.renderNextBlock (outputAudio, startSample, numSamples);
@@ -48,40 +53,7 @@ public:
             while (it != inputMidi.end() && curSample == (*it).samplePosition)
             {
                 // consume event
-                auto midiMsg = (*it).getMessage();
-                int midiStatusByte = (int) (*(midiMsg.getRawData()));
-                if (midiMsg.isNoteOff())
-                {
-                    synth.noteOff (midiMsg.getNoteNumber());
-                }
-                else if (midiMsg.isNoteOn())
-                {
-                    synth.noteOn (midiMsg.getNoteNumber(), static_cast<int> (midiMsg.getVelocity()));
-                }
-                else if (midiMsg.isAllNotesOff())
-                {
-                    synth.allNoteOff();
-                }
-                else if (midiMsg.isPitchWheel())
-                {
-                    synth.setPitchWheel (midiMsg.getPitchWheelValue());
-                }
-                else if (midiMsg.isSustainPedalOn())
-                {
-                    synth.setSustainPedalDown (true);
-                }
-                else if (midiMsg.isSustainPedalOff())
-                {
-                    synth.setSustainPedalDown (false);
-                }
-                else if (midiMsg.isSostenutoPedalOn())
-                {
-                    synth.setSostenutoPedalDown (true);
-                }
-                else if (midiMsg.isSostenutoPedalOff())
-                {
-                    synth.setSostenutoPedalDown (false);
-                }
+                synth.handleMidiEvent (decode (*it));
                 it++;
             }
             // render audio
@@ -100,7 +72,83 @@ public:
         synth.setIsUnison (val);
     }
 
+    // Pitch-wheel values are applied every `numSamples` samples at most.
+    // Successive values within a granule are coalesced into the last one and applied
+    // at the beginning of the granule, so that a dense stream does not split the block
+    // into tiny segments. Other events stay sample-accurate. 1 means every event is sample-accurate.
+    // EngineTelemetry counts coalesced values as MIDI events too.
+    void setControlGranularity (int numSamples)
+    {
+        assert (numSamples >= 1);
+        controlGranularity = std::max (1, numSamples);
+    }
+
+    int getControlGranularity() const
+    {
+        return controlGranularity;
+    }
+
 private:
     SynthEngine& synth;
+    int controlGranularity = 1;
+
+    static MidiEvent decode (const juce::MidiMessageMetadata& metadata)
+    {
+        return MidiDecoder::decode (metadata.data, metadata.numBytes, metadata.samplePosition);
+    }
+
+    void renderNextBlockWithControlGranularity (IAudioBuffer* outputAudio, const juce::MidiBuffer& inputMidi, int startSample, int numSamples)
+    {
+        const int endSample = startSample + numSamples;
+        int curSample = startSample;
+        auto renderUntil = [&] (int sample) {
+            if (sample > curSample)
+            {
+                synth.renderNextBlock (outputAudio, curSample, sample - curSample);
+                curSample = sample;
+            }
+        };
+
+        // The last pitch-wheel value in the current granule, which is not applied yet
+        bool hasPendingPitchWheel = false;
+        int pendingPitchWheel = 0;
+        int pendingSample = startSample;
+        auto applyPendingPitchWheel = [&]() {
+            if (! hasPendingPitchWheel)
+                return;
+            renderUntil (pendingSample);
+            synth.handleMidiEvent ({ MidiEvent::Type::pitchWheel, pendingSample, pendingPitchWheel, 0 });
+            hasPendingPitchWheel = false;
+        };
+
+        for (const auto metadata : inputMidi)
+        {
+            const auto event = decode (metadata);
+            if (event.type == MidiEvent::Type::none)
+                continue;
+            const int sample = std::clamp (event.sample, startSample, endSample);
+            if (event.type == MidiEvent::Type::pitchWheel)
+            {
+                const int granuleStart = startSample + (sample - startSample) / controlGranularity * controlGranularity;
+                // Never go back before an event which has already been applied
+                const int applySample = std::max (granuleStart, curSample);
+                if (hasPendingPitchWheel && applySample != pendingSample)
+                    applyPendingPitchWheel();
+                else if (hasPendingPitchWheel)
+                    synth.getTelemetry().countEvent(); // Coalesced, but received all the same
+                hasPendingPitchWheel = true;
+                pendingPitchWheel = event.value;
+                pendingSample = applySample;
+                continue;
+            }
+
+            if (hasPendingPitchWheel && pendingSample <= sample)
+                applyPendingPitchWheel();
+            renderUntil (sample);
+            synth.handleMidiEvent (event);
+        }
+        applyPendingPitchWheel();
+        renderUntil (endSample);
+    }
 };
 } // namespace onsen
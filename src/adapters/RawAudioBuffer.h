@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+   RawAudioBuffer
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../dsp/DspCommon.h"
+#include "../dsp/IAudioBuffer.h"
+
+namespace onsen
+{
+//==============================================================================
+// Wraps buffers owned by a caller, e.g. an audio server which does not use JUCE.
+class RawAudioBuffer : public IAudioBuffer
+{
+public:
+    RawAudioBuffer() = delete;
+    RawAudioBuffer (flnum* const* _channels, int _numChannels, int _numSamples)
+        : channels (_channels),
+          numChannels (_numChannels),
+          numSamples (_numSamples) {}
+
+    int getNumChannels() const noexcept override
+    {
+        return numChannels;
+    }
+
+    int getNumSamples() const noexcept override
+    {
+        return numSamples;
+    }
+
+    flnum* getWritePointer (int channel) noexcept override
+    {
+        assert (channel < numChannels);
+        return channels[channel];
+    }
+
+    flnum getSample (int channel, int sampleIndex) const noexcept override
+    {
+        assert (channel < numChannels && sampleIndex < numSamples);
+        return channels[channel][sampleIndex];
+    }
+
+    void setSample (int destChannel, int destSample, flnum newValue) noexcept override
+    {
+        assert (destChannel < numChannels && destSample < numSamples);
+        channels[destChannel][destSample] = newValue;
+    }
+
+private:
+    flnum* const* channels;
+    int numChannels;
+    int numSamples;
+};
+} // namespace onsen
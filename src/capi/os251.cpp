@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+   OS-251 C API
+
+  ==============================================================================
+*/
+
+#include "os251.h"
+#include "../synth/HeadlessSynth.h"
+#include <algorithm>
+#include <array>
+#include <new>
+
+struct os251_engine
+{
+    onsen::HeadlessSynth synth;
+};
+
+namespace
+{
+bool isValidSetup (double sampleRate, int maxBlockSize)
+{
+    return sampleRate > 0.0 && maxBlockSize > 0;
+}
+
+bool isValidNote (int note)
+{
+    return 0 <= note && note <= 127;
+}
+
+bool isValidOutputs (float* const* outputs, int numChannels, int numSamples)
+{
+    if (outputs == nullptr || numChannels < 1 || numChannels > onsen::HeadlessSynth::MAX_NUM_CHANNELS || numSamples < 0)
+        return false;
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        if (outputs[ch] == nullptr)
+            return false;
+    }
+    return true;
+}
+
+// Events are decoded into a fixed-size array on the stack so that rendering doesn't allocate
+constexpr int MIDI_EVENT_BATCH_SIZE = 64;
+} // namespace
+
+//==============================================================================
+os251_engine* os251_create (double sample_rate, int max_block_size)
+{
+    if (! isValidSetup (sample_rate, max_block_size))
+        return nullptr;
+    // No exception may propagate to a C caller. The synth allocates its voices in the constructor.
+    try
+    {
+        return new os251_engine { onsen::HeadlessSynth (sample_rate, max_block_size) };
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void os251_destroy (os251_engine* engine)
+{
+    delete engine;
+}
+
+int os251_prepare (os251_engine* engine, double sample_rate, int max_block_size)
+{
+    if (engine == nullptr || ! isValidSetup (sample_rate, max_block_size))
+        return OS251_ERROR_INVALID_ARGUMENT;
+    try
+    {
+        engine->synth.prepareToPlay (sample_rate, max_block_size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return OS251_ERROR_OUT_OF_MEMORY;
+    }
+    return OS251_OK;
+}
+
+//==============================================================================
+int os251_get_num_params (const os251_engine* engine)
+{
+    return engine != nullptr ? engine->synth.getNumParams() : 0;
+}
+
+const char* os251_get_param_id (const os251_engine* engine, int index)
+{
+    if (engine == nullptr || index < 0 || index >= engine->synth.getNumParams())
+        return nullptr;
+    return engine->synth.getParamId (index).c_str();
+}
+
+int os251_set_param (os251_engine* engine, const char* param_id, float value)
+{
+    if (engine == nullptr || param_id == nullptr)
+        return OS251_ERROR_INVALID_ARGUMENT;
+    // Copying the parameter ID into a std::string is what can throw
+    try
+    {
+        return engine->synth.setParam (param_id, value) ? OS251_OK : OS251_ERROR_UNKNOWN_PARAM;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return OS251_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+int os251_get_param (const os251_engine* engine, const char* param_id, float* value)
+{
+    if (engine == nullptr || param_id == nullptr || value == nullptr)
+        return OS251_ERROR_INVALID_ARGUMENT;
+    try
+    {
+        return engine->synth.getParam (param_id, *value) ? OS251_OK : OS251_ERROR_UNKNOWN_PARAM;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return OS251_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+int os251_reset_params (os251_engine* engine)
+{
+    if (engine == nullptr)
+        return OS251_ERROR_INVALID_ARGUMENT;
+    try
+    {
+        engine->synth.resetParams();
+    }
+    catch (const std::bad_alloc&)
+    {
+        return OS251_ERROR_OUT_OF_MEMORY;
+    }
+    return OS251_OK;
+}
+
+void os251_set_bpm (os251_engine* engine, float bpm)
+{
+    if (engine != nullptr && bpm > 0.0f)
+        engine->synth.setBpm (bpm);
+}
+
+int os251_load_preset (os251_engine* engine, const void* data, size_t size)
+{
+    if (engine == nullptr || data == nullptr)
+        return OS251_ERROR_INVALID_ARGUMENT;
+    try
+    {
+        return engine->synth.loadPreset (data, size) ? OS251_OK : OS251_ERROR_INVALID_PRESET;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return OS251_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+//==============================================================================
+int os251_note_on (os251_engine* engine, int note, int velocity)
+{
+    if (engine == nullptr || ! isValidNote (note) || velocity < 0 || velocity > 127)
+        return OS251_ERROR_INVALID_ARGUMENT;
+    const auto type = velocity > 0 ? onsen::MidiEvent::Type::noteOn : onsen::MidiEvent::Type::noteOff;
+    engine->synth.handleMidiEvent ({ type, 0, note, velocity });
+    return OS251_OK;
+}
+
+int os251_note_off (os251_engine* engine, int note)
+{
+    if (engine == nullptr || ! isValidNote (note))
+        return OS251_ERROR_INVALID_ARGUMENT;
+    engine->synth.handleMidiEvent ({ onsen::MidiEvent::Type::noteOff, 0, note, 0 });
+    return OS251_OK;
+}
+
+int os251_pitch_wheel (os251_engine* engine, int value)
+{
+    if (engine == nullptr || value < 0 || value > 16383)
+        return OS251_ERROR_INVALID_ARGUMENT;
+    engine->synth.handleMidiEvent ({ onsen::MidiEvent::Type::pitchWheel, 0, value, 0 });
+    return OS251_OK;
+}
+
+int os251_sustain_pedal (os251_engine* engine, int down)
+{
+    if (engine == nullptr)
+        return OS251_ERROR_INVALID_ARGUMENT;
+    engine->synth.handleMidiEvent ({ onsen::MidiEvent::Type::sustainPedal, 0, down != 0 ? 1 : 0, 0 });
+    return OS251_OK;
+}
+
+void os251_all_notes_off (os251_engine* engine)
+{
+    if (engine != nullptr)
+        engine->synth.allNoteOff();
+}
+
+int os251_midi (os251_engine* engine, const uint8_t* data, int num_bytes)
+{
+    if (engine == nullptr || data == nullptr || num_bytes <= 0)
+        return OS251_ERROR_INVALID_ARGUMENT;
+    engine->synth.handleMidiEvent (onsen::MidiDecoder::decode (data, num_bytes, 0));
+    return OS251_OK;
+}
+
+//==============================================================================
+int os251_render (os251_engine* engine, float* const* outputs, int num_channels, int num_samples)
+{
+    if (engine == nullptr || ! isValidOutputs (outputs, num_channels, num_samples))
+        return OS251_ERROR_INVALID_ARGUMENT;
+    engine->synth.render (outputs, num_channels, num_samples);
+    return OS251_OK;
+}
+
+int os251_render_midi (os251_engine* engine, float* const* outputs, int num_channels, int num_samples,
+                       const os251_midi_event* events, int num_events)
+{
+    if (engine == nullptr || ! isValidOutputs (outputs, num_channels, num_samples)
+        || num_events < 0 || (num_events > 0 && events == nullptr))
+        return OS251_ERROR_INVALID_ARGUMENT;
+
+    // Renders the block in sections of up to MIDI_EVENT_BATCH_SIZE events.
+    // A section ends where the first event of the next section starts.
+    std::array<onsen::MidiEvent, MIDI_EVENT_BATCH_SIZE> batch;
+    std::array<float*, onsen::HeadlessSynth::MAX_NUM_CHANNELS> channels {};
+    int eventIdx = 0;
+    int curSample = 0;
+    while (eventIdx < num_events || curSample < num_samples)
+    {
+        const int numBatchEvents = std::min (num_events - eventIdx, MIDI_EVENT_BATCH_SIZE);
+        for (int i = 0; i < numBatchEvents; i++)
+        {
+            const auto& event = events[eventIdx + i];
+            batch[i] = onsen::MidiDecoder::decode (event.data, std::min (event.num_bytes, 3), event.sample - curSample);
+        }
+        eventIdx += numBatchEvents;
+
+        int endSample = num_samples;
+        if (eventIdx < num_events)
+            endSample = std::clamp (events[eventIdx].sample, curSample, num_samples);
+        for (int ch = 0; ch < num_channels; ch++)
+            channels[ch] = outputs[ch] + curSample;
+        engine->synth.render (channels.data(), num_channels, endSample - curSample, batch.data(), numBatchEvents);
+        curSample = endSample;
+    }
+    return OS251_OK;
+}
+
+int os251_is_clipping (os251_engine* engine)
+{
+    return engine != nullptr && engine->synth.isClipping() ? 1 : 0;
+}
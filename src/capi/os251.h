@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+   OS-251 C API
+
+  ==============================================================================
+*/
+
+/*
+A plain C API of the OS-251 engine for embedding it in an audio server or
+a game runtime. It does not depend on JUCE.
+
+Nothing is thread-safe. Calls for an engine must be serialized by a caller,
+e.g. by calling everything on the audio thread.
+Functions returning int return OS251_OK on success.
+*/
+
+#ifndef OS251_CAPI_H
+#define OS251_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(OS251_SHARED)
+    #ifdef OS251_CAPI_BUILD
+        #define OS251_API __declspec (dllexport)
+    #else
+        #define OS251_API __declspec (dllimport)
+    #endif
+#elif defined(__GNUC__)
+    #define OS251_API __attribute__ ((visibility ("default")))
+#else
+    #define OS251_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OS251_OK 0
+#define OS251_ERROR_INVALID_ARGUMENT (-1)
+#define OS251_ERROR_UNKNOWN_PARAM (-2)
+#define OS251_ERROR_INVALID_PRESET (-3)
+#define OS251_ERROR_OUT_OF_MEMORY (-4)
+
+typedef struct os251_engine os251_engine;
+
+/*
+Returns NULL on failure.
+max_block_size is deprecated and ignored. The engine renders any number of samples in fixed
+internal chunks. It still has to be positive for compatibility.
+*/
+OS251_API os251_engine* os251_create (double sample_rate, int max_block_size);
+OS251_API void os251_destroy (os251_engine* engine);
+OS251_API int os251_prepare (os251_engine* engine, double sample_rate, int max_block_size);
+
+/* Parameters. Values are normalized to [0, 1] like the plugin's ones. */
+OS251_API int os251_get_num_params (const os251_engine* engine);
+/* Returns NULL if the index is out of range. The string is owned by the engine. */
+OS251_API const char* os251_get_param_id (const os251_engine* engine, int index);
+OS251_API int os251_set_param (os251_engine* engine, const char* param_id, float value);
+OS251_API int os251_get_param (const os251_engine* engine, const char* param_id, float* value);
+OS251_API int os251_reset_params (os251_engine* engine);
+OS251_API void os251_set_bpm (os251_engine* engine, float bpm);
+
+/* Loads a preset record (.oapresetb). Parameters which are not in the preset get their default values. */
+OS251_API int os251_load_preset (os251_engine* engine, const void* data, size_t size);
+
+/*
+MIDI
+These functions apply a message immediately, so it takes effect at the start of the next
+os251_render() call. Use os251_render_midi() for sample-accurate timing.
+*/
+OS251_API int os251_note_on (os251_engine* engine, int note, int velocity);
+OS251_API int os251_note_off (os251_engine* engine, int note);
+OS251_API int os251_pitch_wheel (os251_engine* engine, int value);
+OS251_API int os251_sustain_pedal (os251_engine* engine, int down);
+OS251_API void os251_all_notes_off (os251_engine* engine);
+/* A raw MIDI message. Messages which the engine does not use are ignored. */
+OS251_API int os251_midi (os251_engine* engine, const uint8_t* data, int num_bytes);
+
+/*
+Overwrites num_channels (1 or 2) buffers with num_samples samples.
+Buffers are provided by a caller and they are non-interleaved.
+*/
+OS251_API int os251_render (os251_engine* engine, float* const* outputs, int num_channels, int num_samples);
+
+/* A raw MIDI message with its position in a rendered block */
+typedef struct os251_midi_event
+{
+    int sample;
+    int num_bytes; /* Up to 3. Longer messages are truncated. */
+    uint8_t data[3];
+} os251_midi_event;
+
+/*
+Same as os251_render() but applies events at their sample positions.
+Events must be sorted by sample. Events at or after num_samples are applied after rendering.
+*/
+OS251_API int os251_render_midi (os251_engine* engine, float* const* outputs, int num_channels, int num_samples,
+                                 const os251_midi_event* events, int num_events);
+OS251_API int os251_is_clipping (os251_engine* engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OS251_CAPI_H */
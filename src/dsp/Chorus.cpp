@@ -13,29 +13,238 @@ namespace onsen
 //==============================================================================
 void Chorus::render (IAudioBuffer* outputAudio, int startSample, int numSamples)
 {
+    renderDelay (outputAudio, startSample, numSamples);
+    // An endless tail rings for as long as an int counts
+    const double tailSamples = std::ceil (getTailLengthSeconds() * sampleRate);
+    remainingTailSamples = tailSamples < std::numeric_limits<int>::max() ? static_cast<int> (tailSamples) : std::numeric_limits<int>::max();
+}
+
+bool Chorus::renderSilentInput (IAudioBuffer* outputAudio, int startSample, int numSamples)
+{
+    if (remainingTailSamples <= 0)
+        return true;
+
+    renderDelay (outputAudio, startSample, numSamples);
+    remainingTailSamples -= numSamples;
+    if (remainingTailSamples <= 0)
+    {
+        // What is left in the delay line is below the threshold
+        std::fill_n (buf.begin(), bufSize + MIRROR_SIZE, 0.0);
+    }
+    return false;
+}
+
+double Chorus::getTailLengthSeconds() const
+{
+    const double roundTripSeconds = delayTime_msec * (1.0 + depth) / 1000.0;
+    if (feedback <= 0.0)
+        return roundTripSeconds;
+    if (feedback >= 1.0)
+        return std::numeric_limits<double>::infinity();
+
+    // The first pass through the delay line reaches the output at unity gain.
+    // Every round trip after that multiplies the signal by the feedback.
+    const auto numRoundTrips = std::ceil (std::log (SILENCE_THRESHOLD) / std::log (feedback));
+    return (numRoundTrips + 1) * roundTripSeconds;
+}
+
+void Chorus::renderDelay (IAudioBuffer* outputAudio, int startSample, int numSamples)
+{
+    const int numChannels = outputAudio->getNumChannels();
+    const int maxRunLength = getMaxRunLength();
+    // Other layouts get the mean of both sides of the ensemble
+    const bool isStereoEnsemble = numTaps > 1 && numChannels == 2;
+    const flnum monoWetLevel = isStereoEnsemble ? 0.0 : wetLevel;
     int idx = startSample;
-    while (--numSamples >= 0)
+    while (numSamples > 0)
     {
+        // The write pointer doesn't wrap within a run
+        const int runLength = std::min ({ numSamples, maxRunLength, bufSize - writePointer });
+        if (numTaps > 1)
+            readEnsembleTaps (runLength);
+        else
+            readDelayLine (runLength);
+
         // Convert input to mono
-        flnum monoInputVal = 0.0;
-        for (auto i = outputAudio->getNumChannels(); --i >= 0;)
+        std::fill_n (monoInputVals.begin(), runLength, 0.0);
+        for (auto ch = numChannels; --ch >= 0;)
+        {
+            const flnum* const inputPtr = outputAudio->getWritePointer (ch) + idx;
+            for (int i = 0; i < runLength; i++)
+                monoInputVals[i] += inputPtr[i];
+        }
+
+        flnum* const writePtr = buf.data() + writePointer;
+        for (int i = 0; i < runLength; i++)
+        {
+            const flnum monoInputVal = monoInputVals[i] / numChannels;
+            writePtr[i] = monoInputVal + delayedVals[i] * feedback;
+            // Reused for the output
+            monoInputVals[i] = monoInputVal * dryLevel + delayedVals[i] * monoWetLevel;
+        }
+
+        if (isStereoEnsemble)
+        {
+            for (int ch = 0; ch < 2; ch++)
+            {
+                flnum* const outputPtr = outputAudio->getWritePointer (ch) + idx;
+                for (int i = 0; i < runLength; i++)
+                    outputPtr[i] = monoInputVals[i] + ensembleVals[ch][i] * wetLevel;
+            }
+        }
+        else
+        {
+            // Every channel gets the same output
+            for (auto ch = numChannels; --ch >= 0;)
+                std::copy_n (monoInputVals.begin(), runLength, outputAudio->getWritePointer (ch) + idx);
+        }
+
+        for (int i = writePointer; i < std::min (MIRROR_SIZE, writePointer + runLength); i++)
+            buf[bufSize + i] = buf[i];
+
+        writePointer = (writePointer + runLength) & bufMask;
+        idx += runLength;
+        numSamples -= runLength;
+    }
+}
+
+void Chorus::readDelayLine (int runLength)
+{
+    // The LFO moves the read position. It's whole samples without interpolation.
+    for (int i = 0; i < runLength; i++)
+    {
+        delayTimesInSample[i] = interpolateBufferAccess
+                                    ? delayTimeInSec() * sampleRate
+                                    : static_cast<int> (delayTime_msec * (1.0 + depth * lfo.getSin()) / 1000.0 * sampleRate);
+        lfo.advance();
+    }
+
+    const flnum* const ring = buf.data();
+    if (interpolateBufferAccess)
+    {
+        // Use linear interpolation
+        // https://ccrma.stanford.edu/~jos/pasp/Delay_Line_Interpolation.html
+        for (int i = 0; i < runLength; i++)
         {
-            monoInputVal += outputAudio->getSample (i, idx);
+            const flnum delayTimeInSample = delayTimesInSample[i];
+            const int firstIdx = (writePointer + i - (static_cast<int> (delayTimeInSample) + 1)) & bufMask;
+            const flnum firstRatio = delayTimeInSample - std::floor (delayTimeInSample);
+            // [Circuit Bending]
+            // delayedVals[i] = ring[firstIdx] * firstIdx + ring[firstIdx + 1] * (1.0 - firstIdx);
+            delayedVals[i] = ring[firstIdx] * firstRatio + ring[firstIdx + 1] * (1.0 - firstRatio);
         }
-        monoInputVal /= outputAudio->getNumChannels();
+    }
+    else
+    {
+        // It has zipper noise
+        for (int i = 0; i < runLength; i++)
+            delayedVals[i] = ring[(writePointer + i - static_cast<int> (delayTimesInSample[i])) & bufMask];
+    }
+}
 
-        const flnum delayVal = getModDelayValue();
-        buf.at (writePointer) = monoInputVal + delayVal * feedback;
-        flnum outputVal = monoInputVal * dryLevel + delayVal * wetLevel;
-        for (auto i = outputAudio->getNumChannels(); --i >= 0;)
+void Chorus::readEnsembleTaps (int runLength)
+{
+    // One LFO for all taps. sin (a + b) = sin (a) * cos (b) + cos (a) * sin (b) gives the
+    // phase of each tap, so adding a tap doesn't add an oscillator.
+    std::array<flnum, MAX_RUN_LENGTH> lfoSins;
+    std::array<flnum, MAX_RUN_LENGTH> lfoCoss;
+    for (int i = 0; i < runLength; i++)
+    {
+        lfoSins[i] = lfo.getSin();
+        lfoCoss[i] = lfo.getCos();
+        lfo.advance();
+    }
+
+    for (auto& vals : ensembleVals)
+        std::fill_n (vals.begin(), runLength, 0.0);
+
+    constexpr flnum msecPerSec = 1000.0;
+    constexpr flnum one = 1.0;
+    constexpr flnum half = 0.5;
+    const flnum* const ring = buf.data();
+    const flnum delayTimeInSample = delayTime_msec / msecPerSec * sampleRate;
+    // Four samples around each read position, from the oldest
+    std::array<std::array<flnum, MAX_RUN_LENGTH>, 4> points;
+    std::array<int, MAX_RUN_LENGTH> readIdxs;
+    std::array<flnum, MAX_RUN_LENGTH> ratios;
+    for (int tap = 0; tap < numTaps; tap++)
+    {
+        // The loops over the run except the reads from the ring are vectorized
+        const flnum sinOffset = tapSinOffsets[tap];
+        const flnum cosOffset = tapCosOffsets[tap];
+        for (int i = 0; i < runLength; i++)
         {
-            outputAudio->setSample (i, idx, outputVal);
+            const flnum tapSin = lfoSins[i] * cosOffset + lfoCoss[i] * sinOffset;
+            const flnum tapDelayInSample = delayTimeInSample * (one + depth * tapSin);
+            const int intDelay = static_cast<int> (tapDelayInSample);
+            // From the older of the two samples around the read position to the newer one
+            ratios[i] = one - (tapDelayInSample - intDelay);
+            // Two samples before the newer one, so that four samples are read from here
+            readIdxs[i] = (writePointer + i - intDelay - 2) & bufMask;
         }
 
-        // Update LFO's state
-        lfo.update();
-        idx++;
-        writePointer = (writePointer + 1) % buf.size();
+        for (int i = 0; i < runLength; i++)
+        {
+            const flnum* const p = ring + readIdxs[i];
+            points[0][i] = p[0];
+            points[1][i] = p[1];
+            points[2][i] = p[2];
+            points[3][i] = p[3];
+        }
+
+        // Even taps go to the left and odd ones to the right
+        flnum* const tapVals = ensembleVals[tap % 2].data();
+        const flnum gain = tapGains[tap];
+        if (interpolateBufferAccess)
+        {
+            // Use cubic Hermite (Catmull-Rom) interpolation. The read positions of the taps keep
+            // moving, and linear interpolation would dull the highs as they do.
+            constexpr flnum oneAndHalf = 1.5;
+            constexpr flnum two = 2.0;
+            constexpr flnum twoAndHalf = 2.5;
+            for (int i = 0; i < runLength; i++)
+            {
+                const flnum xm1 = points[0][i];
+                const flnum x0 = points[1][i];
+                const flnum x1 = points[2][i];
+                const flnum x2 = points[3][i];
+                const flnum t = ratios[i];
+                const flnum c1 = half * (x1 - xm1);
+                const flnum c2 = xm1 - twoAndHalf * x0 + two * x1 - half * x2;
+                const flnum c3 = half * (x2 - xm1) + oneAndHalf * (x0 - x1);
+                tapVals[i] += (((c3 * t + c2) * t + c1) * t + x0) * gain;
+            }
+        }
+        else
+        {
+            // It has zipper noise
+            for (int i = 0; i < runLength; i++)
+                tapVals[i] += points[2][i] * gain;
+        }
+    }
+
+    // Fed back and used for layouts other than stereo
+    for (int i = 0; i < runLength; i++)
+        delayedVals[i] = half * (ensembleVals[0][i] + ensembleVals[1][i]);
+}
+
+void Chorus::setNumTaps (int val)
+{
+    val = std::clamp (val, 1, MAX_NUM_TAPS);
+    if (val == numTaps)
+        return;
+
+    numTaps = val;
+    // Each channel gets the mean of its taps
+    const int numTapsL = (numTaps + 1) / 2;
+    const int numTapsR = numTaps / 2;
+    for (int tap = 0; tap < numTaps; tap++)
+    {
+        // Spread evenly over the cycle. With 4 or 8 taps the two channels are in quadrature.
+        const double phaseOffset = 2.0 * pi * tap / numTaps;
+        tapSinOffsets[tap] = std::sin (phaseOffset);
+        tapCosOffsets[tap] = std::cos (phaseOffset);
+        tapGains[tap] = 1.0 / (tap % 2 == 0 ? numTapsL : numTapsR);
     }
 }
 
@@ -47,9 +256,14 @@ void Chorus::setCurrentPlaybackSampleRate (double _sampleRate)
 
 void Chorus::prepare()
 {
-    const auto bufSize = static_cast<int> (sampleRate * maxDelayTime_msec / 1000.0);
-    assert (bufSize > 0);
-    buf.resize (bufSize, 0.0);
+    lfo.setFrequency (lfoFreq, sampleRate);
+    bufSize = getRingSize (sampleRate);
+    bufMask = bufSize - 1;
+    if (bufSize + MIRROR_SIZE > static_cast<int> (buf.size()))
+        buf.resize (bufSize + MIRROR_SIZE);
+    // The delay line of the previous rate makes no sense at the new one
+    std::fill_n (buf.begin(), bufSize + MIRROR_SIZE, 0.0);
     writePointer = 0;
+    remainingTailSamples = 0;
 }
 } // namespace onsen
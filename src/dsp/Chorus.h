@@ -10,6 +10,10 @@
 
 #include "DspCommon.h"
 #include "IAudioBuffer.h"
+#include "QuadratureOscillator.h"
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <vector>
 
 namespace onsen
@@ -17,135 +21,115 @@ namespace onsen
 //==============================================================================
 class Chorus
 {
-    struct ChorusLfo
-    {
-    public:
-        flnum val() const
-        {
-            return sinWave (currentAngle);
-        }
-
-        void update()
-        {
-            currentAngle += angleDelta();
-            if (currentAngle > 2.0 * pi)
-                currentAngle -= 2.0 * pi;
-        }
-
-    private:
-        flnum angleDelta() const
-        {
-            return 2.0 * pi * freq / sampleRate;
-        }
-
-        static flnum sinWave (flnum angle)
-        {
-            return std::sin (angle);
-        }
-
-    public:
-        flnum currentAngle;
-        flnum freq;
-        const flnum& sampleRate;
-    };
-
 public:
     Chorus()
         : sampleRate (DEFAULT_SAMPLE_RATE),
           delayTime_msec (15.0),
           feedback (0.3),
           maxDelayTime_msec (20.0),
+          buf (getRingSize (MAX_SAMPLE_RATE) + MIRROR_SIZE, 0.0),
+          bufSize (0),
+          bufMask (0),
           writePointer (0),
-          lfo ({ 0.0, 0.5, sampleRate }),
+          lfo(),
+          lfoFreq (0.5),
           depth (0.1),
           dryLevel (1.0),
           wetLevel (1.0),
-          interpolateBufferAccess (true)
+          interpolateBufferAccess (true),
+          remainingTailSamples (0),
+          numTaps (0)
     {
         prepare();
+        setNumTaps (1);
     };
 
     void render (IAudioBuffer* outputAudio, int startSample, int numSamples);
+    // Used instead of render() for silent input. It renders only while the feedback rings.
+    // Returns true if the output is silent.
+    bool renderSilentInput (IAudioBuffer* outputAudio, int startSample, int numSamples);
+    // It allocates only for rates above MAX_SAMPLE_RATE
     void setCurrentPlaybackSampleRate (double _sampleRate);
+    // Time for the feedback to decay below SILENCE_THRESHOLD. It's infinite for feedback of 1 or more.
+    double getTailLengthSeconds() const;
+    void setFeedback (flnum val) { feedback = val; }
+    // Without interpolation it's cheaper but has zipper noise
+    void setInterpolateBufferAccess (bool val) { interpolateBufferAccess = val; }
+    // 1 is the classic mono chorus. 2 or more taps make a stereo ensemble.
+    void setNumTaps (int val);
+
+    static constexpr int MAX_NUM_TAPS = 8;
 
 private:
+    // buf[bufSize + i] mirrors buf[i], so that the interpolation can read up to buf[idx + 3] without a wrap
+    static constexpr int MIRROR_SIZE = 3;
+    // Delayed values are read for up to this many samples at once
+    static constexpr int MAX_RUN_LENGTH = 64;
+
     flnum sampleRate;
     flnum delayTime_msec;
     flnum feedback;
     flnum maxDelayTime_msec;
+    // Allocated for MAX_SAMPLE_RATE. A ring of the first bufSize (a power of two) samples
+    // and its mirror are used at the current rate.
     std::vector<flnum> buf;
+    int bufSize;
+    int bufMask;
     int writePointer;
-    ChorusLfo lfo;
+    QuadratureOscillator lfo;
+    flnum lfoFreq;
     flnum depth;
     flnum dryLevel;
     flnum wetLevel;
     bool interpolateBufferAccess;
+    // Samples to render after the input became silent
+    int remainingTailSamples;
+    // Scratch for a run
+    std::array<flnum, MAX_RUN_LENGTH> delayTimesInSample;
+    std::array<flnum, MAX_RUN_LENGTH> delayedVals;
+    std::array<flnum, MAX_RUN_LENGTH> monoInputVals;
+
+    // Ensemble. Taps alternate between the left and the right channel. Their LFO phases
+    // are spread over the cycle and derived from `lfo`'s sine and cosine.
+    int numTaps;
+    std::array<flnum, MAX_NUM_TAPS> tapSinOffsets;
+    std::array<flnum, MAX_NUM_TAPS> tapCosOffsets;
+    std::array<flnum, MAX_NUM_TAPS> tapGains;
+    // Wet output of each channel for a run. delayedVals has the mean of the two.
+    std::array<std::array<flnum, MAX_RUN_LENGTH>, 2> ensembleVals;
 
     //==============================================================================
     void prepare();
+    void renderDelay (IAudioBuffer* outputAudio, int startSample, int numSamples);
+    void readDelayLine (int runLength);
+    void readEnsembleTaps (int runLength);
 
-    inline int delaySample()
+    int getRingSize (flnum rate) const
     {
-        return static_cast<int> (delayTime_msec * (1.0 + depth * lfo.val()) / 1000.0 * sampleRate);
+        const auto maxDelaySamples = static_cast<int> (rate * maxDelayTime_msec / 1000.0);
+        int size = 1;
+        while (size < maxDelaySamples)
+            size *= 2;
+        return size;
     }
 
-    inline int readIdx()
+    // Samples written in a run are not read back in the same run if it's shorter than this
+    int getMinDelaySamples() const
     {
-        const int idx = writePointer - delaySample();
-        return idx >= 0 ? idx : idx + static_cast<int> (buf.size());
+        return std::max (1, static_cast<int> (delayTime_msec * (1.0 - depth) / 1000.0 * sampleRate));
     }
 
-    inline flnum getModDelayValueWithoutInterpolation()
+    int getMaxRunLength() const
     {
-        return buf.at (readIdx());
+        // The cubic interpolation of the ensemble reads one sample newer than the linear one.
+        // One more covers the rounding of the taps' delay times.
+        const int lookahead = numTaps > 1 ? 2 : 0;
+        return std::max (1, std::min (MAX_RUN_LENGTH, getMinDelaySamples() - lookahead));
     }
 
     inline flnum delayTimeInSec()
     {
-        return delayTime_msec * (1.0 + depth * lfo.val()) / 1000.0;
-    }
-
-    inline int firstReadIdx (const flnum delayTimeInSample)
-    {
-        const int idx = writePointer - (static_cast<int> (delayTimeInSample) + 1);
-
-        return idx >= 0 ? idx : idx + static_cast<int> (buf.size());
-    }
-
-    inline flnum firstReadSampleRatio (const flnum delayTimeInSample)
-    {
-        return delayTimeInSample - std::floor (delayTimeInSample);
-    }
-
-    inline flnum getBufValueWithInterpolation (int firstIdx, int secondIdx, flnum firstRatio)
-    {
-        // [Circuit Bending]
-        // return buf.at(firstIdx) * firstIdx + buf.at(secondIdx) * (1.0 - firstIdx);
-        return buf.at (firstIdx) * firstRatio + buf.at (secondIdx) * (1.0 - firstRatio);
-    }
-
-    inline flnum getModDelayValueWithInterpolation()
-    {
-        // Use linear interpolation
-        // https://ccrma.stanford.edu/~jos/pasp/Delay_Line_Interpolation.html
-        const flnum delayTimeInSample = delayTimeInSec() * sampleRate;
-        const flnum firstIdx = firstReadIdx (delayTimeInSample);
-        const flnum secondIdx = (firstIdx == static_cast<int> (buf.size()) - 1) ? 0 : firstIdx + 1;
-        const flnum firstRatio = firstReadSampleRatio (delayTimeInSample);
-        return getBufValueWithInterpolation (firstIdx, secondIdx, firstRatio);
-    }
-
-    inline flnum getModDelayValue()
-    {
-        if (interpolateBufferAccess)
-        {
-            return getModDelayValueWithInterpolation();
-        }
-        else
-        {
-            // It has zipper noise
-            return getModDelayValueWithoutInterpolation();
-        }
+        return delayTime_msec * (1.0 + depth * lfo.getSin()) / 1000.0;
     }
 };
 } // namespace onsen
@@ -18,9 +18,15 @@ namespace onsen
 using flnum = float;
 static constexpr flnum DEFAULT_SAMPLE_RATE = 44100.0;
 static constexpr int DEFAULT_SAMPLES_PER_BLOCK = 512;
+// Buffers are preallocated for this, so that hosts can switch up to it without allocations
+static constexpr flnum MAX_SAMPLE_RATE = 192000.0;
+// SynthEngine renders blocks of any size in chunks of this many samples
+static constexpr int PROCESSING_QUANTUM = 64;
 // TODO: change const to capital letters
 static constexpr flnum pi = 3.141592653589793238L;
 static constexpr flnum EPSILON = std::numeric_limits<flnum>::epsilon();
+// Samples below this (-100 dB) are regarded as silence
+static constexpr flnum SILENCE_THRESHOLD = 1.0e-5;
 //==============================================================================
 namespace DspUtil
 {
@@ -91,6 +97,8 @@ public:
           initialized (false) {}
     flnum get() const { return cur; }
     void update() { cur = adjustedSmoothness * cur + (1 - adjustedSmoothness) * target; }
+    // Same as calling update() numSteps times, up to rounding
+    void update (int numSteps) { cur = target + (cur - target) * std::pow (adjustedSmoothness, numSteps); }
     void set (flnum val)
     {
         if (! initialized)
@@ -81,6 +81,12 @@ public:
         fb.out2 = 0.0;
     }
 
+    // Snaps the frequency to the envelope's current level, so it doesn't glide from the previous note
+    void resetFrequency()
+    {
+        smoothedFreq.reset (env->getLevel() * p->getFilterEnvelope());
+    }
+
     void setCurrentPlaybackSampleRate (double _sampleRate)
     {
         sampleRate = static_cast<flnum> (_sampleRate);
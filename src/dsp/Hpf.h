@@ -13,21 +13,43 @@
 #include "Envelope.h"
 #include "IAudioBuffer.h"
 #include "Lfo.h"
+#include <array>
+#include <vector>
 
 namespace onsen
 {
 //==============================================================================
+
+/*
+Hpf
+
+A biquad high pass filter. Channels are filtered in pairs which share one set
+of coefficients, so the coefficients are computed once for both and the two
+channels sit in the lanes of one vector.
+
+The coefficients are divided by a0 in advance. Each render() ramps them from
+the frequency at the end of the previous call to the one at the end of this
+call, so a moving frequency doesn't jump at the boundaries of the calls. A
+linear ramp between two stable biquads is stable, because the stable region of
+(a1, a2) is a triangle.
+*/
 class Hpf
 {
     using flnum = float;
+    // Channels filtered together
+    static constexpr int NUM_LANES = 2;
+
+    struct Coefficients
+    {
+        flnum b0, b1, b2, a1, a2;
+    };
+
+    // State of NUM_LANES channels
     struct FilterBuffer
     {
     public:
-        FilterBuffer() : in1 (0.0), in2 (0.0), out1 (0.0), out2 (0.0) {}
-        ~FilterBuffer() = default;
-        ;
-        flnum in1, in2;
-        flnum out1, out2;
+        std::array<flnum, NUM_LANES> in1 {}, in2 {};
+        std::array<flnum, NUM_LANES> out1 {}, out2 {};
     };
 
 public:
@@ -36,28 +58,90 @@ public:
         : p (hpfParams),
           sampleRate (DEFAULT_SAMPLE_RATE),
           numChannels (_numChannels),
-          filterBuffers (numChannels),
+          filterBuffers ((numChannels + NUM_LANES - 1) / NUM_LANES),
           smoothedFreq (0.0, 0.999)
     {
         smoothedFreq.reset (p->getFrequency());
+        coefs = makeCoefficients (smoothedFreq.get());
     }
 
     void render (IAudioBuffer* outputAudio, int startSample, int numSamples)
     {
-        // Set biquad parameter coefficients
-        // https://webaudio.github.io/Audio-EQ-Cookbook/audio-eq-cookbook.html
+        const int endSample = std::min (outputAudio->getNumSamples(), startSample + numSamples);
+        if (endSample <= startSample)
+            return;
 
-        flnum targetFreq = p->getFrequency();
-        smoothedFreq.set (targetFreq);
+        smoothedFreq.set (p->getFrequency());
+        smoothedFreq.update (endSample - startSample);
+        const Coefficients target = makeCoefficients (smoothedFreq.get());
 
-        int numInputChannels = outputAudio->getNumChannels();
-        int bufferSize = outputAudio->getNumSamples();
-        for (int i = startSample; i < bufferSize && i < startSample + numSamples; i++)
+        const int numRenderedChannels = std::min (numChannels, outputAudio->getNumChannels());
+        for (int channel = 0; channel < numRenderedChannels; channel += NUM_LANES)
         {
-            smoothedFreq.update();
+            FilterBuffer& fb = filterBuffers[channel / NUM_LANES];
+            if (numRenderedChannels - channel >= NUM_LANES)
+                renderLanes<NUM_LANES> (outputAudio, channel, fb, target, startSample, endSample);
+            else
+                renderLanes<1> (outputAudio, channel, fb, target, startSample, endSample);
         }
+        coefs = target;
+    }
+
+    void setCurrentPlaybackSampleRate (double _sampleRate)
+    {
+        sampleRate = static_cast<flnum> (_sampleRate);
+        smoothedFreq.prepareToPlay (_sampleRate);
+        coefs = makeCoefficients (smoothedFreq.get());
+    }
+
+    // True if the filter's state has decayed, so silent input gives silent output
+    bool isIdle() const
+    {
+        for (const auto& fb : filterBuffers)
+        {
+            for (int lane = 0; lane < NUM_LANES; lane++)
+            {
+                if (std::abs (fb.in1[lane]) >= SILENCE_THRESHOLD || std::abs (fb.in2[lane]) >= SILENCE_THRESHOLD
+                    || std::abs (fb.out1[lane]) >= SILENCE_THRESHOLD || std::abs (fb.out2[lane]) >= SILENCE_THRESHOLD)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Used instead of render() for silent input while isIdle().
+    // Only the frequency moves and the state is flushed to zero.
+    void skip (int numSamples)
+    {
+        smoothedFreq.set (p->getFrequency());
+        smoothedFreq.update (numSamples);
+        coefs = makeCoefficients (smoothedFreq.get());
+        std::fill (filterBuffers.begin(), filterBuffers.end(), FilterBuffer());
+    }
+
+    // Snaps the frequency to the parameter and clears the state, e.g. after a preset change
+    void reset()
+    {
+        smoothedFreq.reset (p->getFrequency());
+        coefs = makeCoefficients (smoothedFreq.get());
+        std::fill (filterBuffers.begin(), filterBuffers.end(), FilterBuffer());
+    }
 
-        flnum omega0 = 2.0f * 3.14159265f * smoothedFreq.get() / sampleRate;
+private:
+    const IHpfParams* const p;
+    flnum sampleRate;
+    int numChannels;
+    // A buffer per NUM_LANES channels. The unused lanes of the last one stay zero.
+    std::vector<FilterBuffer> filterBuffers;
+    SmoothFlnum smoothedFreq;
+    // Where the ramp of the next render() starts
+    Coefficients coefs;
+
+    Coefficients makeCoefficients (flnum freq) const
+    {
+        // Set biquad parameter coefficients
+        // https://webaudio.github.io/Audio-EQ-Cookbook/audio-eq-cookbook.html
+        flnum omega0 = 2.0f * 3.14159265f * freq / sampleRate;
         flnum sinw0 = std::sin (omega0);
         flnum cosw0 = std::cos (omega0);
         constexpr flnum resonance = 1.0;
@@ -68,40 +152,44 @@ public:
         flnum b0 = (1 + cosw0) / 2.0;
         flnum b1 = -1 - cosw0;
         flnum b2 = (1 + cosw0) / 2.0;
+        return { b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0 };
+    }
 
-        // Calculate output
-
-        for (int channel = 0; channel < std::min (numChannels, numInputChannels); channel++)
+    template <int numLanes>
+    void renderLanes (IAudioBuffer* outputAudio, int firstChannel, FilterBuffer& fb, const Coefficients& target, int startSample, int endSample) const
+    {
+        std::array<flnum*, numLanes> bufferPtrs;
+        for (int lane = 0; lane < numLanes; lane++)
+            bufferPtrs[lane] = outputAudio->getWritePointer (firstChannel + lane);
+
+        const flnum numSteps = static_cast<flnum> (endSample - startSample);
+        const Coefficients delta { (target.b0 - coefs.b0) / numSteps,
+                                   (target.b1 - coefs.b1) / numSteps,
+                                   (target.b2 - coefs.b2) / numSteps,
+                                   (target.a1 - coefs.a1) / numSteps,
+                                   (target.a2 - coefs.a2) / numSteps };
+        Coefficients c = coefs;
+        for (int i = startSample; i < endSample; i++)
         {
-            FilterBuffer& fb = filterBuffers[channel];
-            flnum* bufferPtr = outputAudio->getWritePointer (channel);
-            for (int i = startSample; i < bufferSize && i < startSample + numSamples; i++)
+            c.b0 += delta.b0;
+            c.b1 += delta.b1;
+            c.b2 += delta.b2;
+            c.a1 += delta.a1;
+            c.a2 += delta.a2;
+            for (int lane = 0; lane < numLanes; lane++)
             {
-                flnum out0 = b0 / a0 * bufferPtr[i] + b1 / a0 * fb.in1 + b2 / a0 * fb.in2
-                             - a1 / a0 * fb.out1 - a2 / a0 * fb.out2;
-                fb.in2 = fb.in1;
-                fb.in1 = bufferPtr[i];
+                const flnum in0 = bufferPtrs[lane][i];
+                const flnum out0 = c.b0 * in0 + c.b1 * fb.in1[lane] + c.b2 * fb.in2[lane]
+                                   - c.a1 * fb.out1[lane] - c.a2 * fb.out2[lane];
+                fb.in2[lane] = fb.in1[lane];
+                fb.in1[lane] = in0;
 
-                fb.out2 = fb.out1;
-                fb.out1 = out0;
+                fb.out2[lane] = fb.out1[lane];
+                fb.out1[lane] = out0;
 
-                bufferPtr[i] = out0;
+                bufferPtrs[lane][i] = out0;
             }
         }
     }
-
-    void setCurrentPlaybackSampleRate (double _sampleRate)
-    {
-        sampleRate = static_cast<flnum> (_sampleRate);
-        smoothedFreq.prepareToPlay (_sampleRate);
-    }
-
-private:
-    const IHpfParams* const p;
-    flnum sampleRate;
-    int numChannels;
-    // The length of this vector equals to max number of the channels;
-    std::vector<FilterBuffer> filterBuffers;
-    SmoothFlnum smoothedFreq;
 };
 } // namespace onsen
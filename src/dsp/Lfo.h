@@ -11,6 +11,7 @@
 #include "../synth/SynthParams.h"
 #include "DspCommon.h"
 #include "IPositionInfo.h"
+#include "QuadratureOscillator.h"
 #include <vector>
 
 namespace onsen
@@ -25,10 +26,10 @@ public:
           positionInfo (_positionInfo),
           sampleRate (DEFAULT_SAMPLE_RATE),
           numNoteOn (0),
-          samplesPerBlock (DEFAULT_SAMPLES_PER_BLOCK),
-          buf (samplesPerBlock),
-          bufSync (samplesPerBlock),
-          currentAngle (0.0),
+          samplesPerBlock (PROCESSING_QUANTUM),
+          buf (PROCESSING_QUANTUM),
+          bufSync (PROCESSING_QUANTUM),
+          bufStartSample (0),
           currentAngleSync (0.0),
           amp (0.0),
           ampSync (0.0),
@@ -48,8 +49,9 @@ public:
             amp = ampNoteStart;
             ampSync = ampNoteStart;
             const flnum phase = p->getPhase();
-            currentAngle = 0.0 + phase;
+            osc.setPhase (phase);
             currentAngleSync = 0.0 + phase;
+            oscSync.setPhase (currentAngleSync);
         }
     }
 
@@ -65,34 +67,36 @@ public:
 
     flnum getLevel (int sample) const
     {
+        // `sample` is the index in the block of the last render
+        const int idx = sample - bufStartSample;
         if (p->getSyncOn())
         {
-            assert (sample < bufSync.size());
-            return bufSync[sample];
+            assert (0 <= idx && idx < samplesPerBlock);
+            return bufSync[idx];
         }
-        assert (sample < buf.size());
-        return buf[sample];
+        assert (0 <= idx && idx < samplesPerBlock);
+        return buf[idx];
     }
 
+    // Renders up to samplesPerBlock samples. They are read by getLevel (startSample + i).
     void renderLfo (int startSample, int numSamples)
     {
-        int idx = startSample;
+        assert (numSamples <= samplesPerBlock);
+        bufStartSample = startSample;
+        int idx = 0;
         while (--numSamples >= 0)
         {
-            assert (idx < buf.size());
-            buf[idx++] = lfoWave (currentAngle) * amp;
-            const flnum angleDelta = getAngleDelta();
-            currentAngle += angleDelta;
-            if (currentAngle > pi * 2.0)
-            {
-                currentAngle -= pi * 2.0;
-            }
+            buf[idx++] = MAX_LEVEL * osc.getSin() * amp;
+            osc.setAngleDelta (getAngleDelta());
+            osc.advance();
             updateAmp();
         }
     }
 
     void renderLfoSync (int startSample, int numSamples)
     {
+        assert (numSamples <= samplesPerBlock);
+        bufStartSample = startSample;
         int idx = startSample;
 
         if (! positionInfo)
@@ -108,7 +112,7 @@ public:
             // When DAW starts to play
             isPlaying = true;
             basePosistionInQuarterNote = positionInfo->getPpqPosition();
-            baseAngle = currentAngle;
+            baseAngle = osc.getPhase();
         }
 
         if (isPlaying && ! positionInfo->isPlaying())
@@ -119,14 +123,15 @@ public:
 
         const flnum beatsPerSec = positionInfo->getBpm() / 60.0; // [quarter note / sec]
         const flnum quarterNotesFromBaseToStartIdx = positionInfo->getPpqPosition() - basePosistionInQuarterNote; // [quarter note]
+        oscSync.setAngleDelta (angleDelta (bpm));
         while (--numSamples >= 0)
         {
             // LFO angle from the time DAW starts to play.
             flnum angleFromBase = 0.0; // initialize
             if (isPlaying)
             {
-                assert (idx < bufSync.size());
-                const flnum timeFromBufStartToIdx = (idx - startSample) / sampleRate; // [sec]
+                // The position is the one at the beginning of the host's block
+                const flnum timeFromBufStartToIdx = idx / sampleRate; // [sec]
                 const flnum quarterNotesFromBaseToIdx = quarterNotesFromBaseToStartIdx
                                                         + beatsPerSec * timeFromBufStartToIdx; // [quarter note]
                 const flnum barFromBaseToIdx = quarterNotesFromBaseToIdx / 4;
@@ -150,7 +155,13 @@ public:
                 currentAngleSync = angleAccumulated;
             }
 
-            bufSync[idx++] = lfoWave (currentAngleSync) * ampSync;
+            // The oscillator follows the angle and is set again only when the angle jumps
+            const double phaseError = currentAngleSync - oscSync.getPhase();
+            if (std::abs (phaseError) > MAX_SYNC_PHASE_ERROR
+                && std::abs (std::remainder (phaseError, 2.0 * pi)) > MAX_SYNC_PHASE_ERROR)
+                oscSync.setPhase (currentAngleSync);
+            bufSync[idx++ - startSample] = MAX_LEVEL * oscSync.getSin() * ampSync;
+            oscSync.advance();
 
             if (currentAngleSync > pi * 2.0)
             {
@@ -181,15 +192,21 @@ public:
         sampleRate = static_cast<flnum> (_sampleRate);
     }
 
+    // It allocates only for more than PROCESSING_QUANTUM, which SynthEngine never asks for
     void setSamplesPerBlock (int _samplesPerBlock)
     {
         samplesPerBlock = _samplesPerBlock;
-        buf.resize (samplesPerBlock);
-        bufSync.resize (samplesPerBlock);
+        if (samplesPerBlock > static_cast<int> (buf.size()))
+        {
+            buf.resize (samplesPerBlock);
+            bufSync.resize (samplesPerBlock);
+        }
     }
 
 private:
     static constexpr flnum MAX_LEVEL = 1.0;
+    // [rad] The synced angle is computed in flnum, so it's noisier than the oscillator
+    static constexpr double MAX_SYNC_PHASE_ERROR = 1.0e-3;
 
     const ILfoParams* const p;
     const IPositionInfo* positionInfo;
@@ -201,7 +218,10 @@ private:
     int samplesPerBlock;
     std::vector<flnum> buf;
     std::vector<flnum> bufSync;
-    flnum currentAngle;
+    // Sample index of buf[0] and bufSync[0]
+    int bufStartSample;
+    QuadratureOscillator osc;
+    QuadratureOscillator oscSync;
     flnum currentAngleSync;
     flnum amp;
     flnum ampSync;
@@ -216,11 +236,6 @@ private:
 
     // ---
 
-    static flnum lfoWave (flnum angle)
-    {
-        return MAX_LEVEL * std::sin (angle);
-    }
-
     flnum getAngleDelta() const
     {
         const flnum rate = p->getRate();
@@ -48,6 +48,13 @@ public:
         sampleRate = _sampleRate;
     }
 
+    // Used instead of render() for silent input, which needs no gain
+    void skip (int numSamples)
+    {
+        remainingClipIndicateTimeSec = std::max (0.0, remainingClipIndicateTimeSec - numSamples / sampleRate);
+        _isClipping = remainingClipIndicateTimeSec > 0.0;
+    }
+
     // Clipping indicator UI
     bool isClipping()
     {
@@ -44,7 +44,7 @@ public:
         const auto noiseGain = p->getNoiseGain();
 
         if (sinGain > 0.0)
-            currentSample += sinWave (secondAngleRad) * sinGain;
+            currentSample += (useCheapKernels ? fastSinWave (secondAngleRad) : sinWave (secondAngleRad)) * sinGain;
         if (squareGain > 0.0)
             currentSample += squareWave (secondAngleRad) * squareGain;
         if (sawGain > 0.0)
@@ -67,12 +67,19 @@ public:
         smoothedShape.reset (0.0);
     }
 
+    // Approximated waveforms for when CPU is short
+    void setUseCheapKernels (bool val)
+    {
+        useCheapKernels = val;
+    }
+
 private:
     IOscillatorParams* const p;
     std::random_device seedGen;
     std::default_random_engine randEngine;
     std::uniform_real_distribution<> randDist;
     SmoothFlnum smoothedShape;
+    bool useCheapKernels = false;
 
     static flnum wrapAngle (flnum angle)
     {
@@ -90,6 +97,18 @@ private:
         return std::sin (angle);
     }
 
+    // Parabolic approximation. The error is about 0.1% of the amplitude.
+    static flnum fastSinWave (flnum angle)
+    {
+        constexpr flnum b = 4.0 / pi;
+        constexpr flnum c = -4.0 / (pi * pi);
+        constexpr flnum precision = 0.225;
+        // sin(angle) = -sin(angle - pi) and angle - pi is in [-pi, pi]
+        const flnum x = angle - pi;
+        const flnum y = b * x + c * x * std::abs (x);
+        return -(precision * (y * std::abs (y) - y) + y);
+    }
+
     static flnum squareWave (flnum angle)
     {
         return angle < pi ? 1.0 : -1.0;
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+   Quadrature Oscillator
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "DspCommon.h"
+#include <cmath>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+QuadratureOscillator
+
+Sine and cosine of a steadily rotating angle without std::sin per sample.
+Each step rotates (cos, sin) by the angle delta (coupled form), which is a few
+multiplications. The rounding errors of the rotation slowly change the
+amplitude, so it's pulled back to 1.0 every RENORMALIZATION_INTERVAL steps.
+
+std::sin and std::cos are only called when the phase or the delta is set.
+The state is double so that the error stays far below what an LFO can show.
+*/
+class QuadratureOscillator
+{
+public:
+    QuadratureOscillator() = default;
+
+    // [rad]
+    void setPhase (double angle)
+    {
+        phase = std::fmod (angle, TWO_PI);
+        if (phase < 0.0)
+            phase += TWO_PI;
+        sinVal = std::sin (phase);
+        cosVal = std::cos (phase);
+    }
+
+    // [rad / sample]. Coefficients are recomputed only if it changes.
+    void setAngleDelta (double delta)
+    {
+        if (delta == angleDelta)
+            return;
+        angleDelta = delta;
+        sinDelta = std::sin (delta);
+        cosDelta = std::cos (delta);
+    }
+
+    void setFrequency (double freq, double sampleRate)
+    {
+        setAngleDelta (TWO_PI * freq / sampleRate);
+    }
+
+    flnum getSin() const { return static_cast<flnum> (sinVal); }
+    flnum getCos() const { return static_cast<flnum> (cosVal); }
+    // [0, 2 * pi)
+    double getPhase() const { return phase; }
+
+    void advance()
+    {
+        const double nextSin = sinVal * cosDelta + cosVal * sinDelta;
+        const double nextCos = cosVal * cosDelta - sinVal * sinDelta;
+        sinVal = nextSin;
+        cosVal = nextCos;
+
+        phase += angleDelta;
+        if (phase >= TWO_PI)
+            phase -= TWO_PI;
+
+        if (++numStepsSinceRenormalization >= RENORMALIZATION_INTERVAL)
+            renormalize();
+    }
+
+private:
+    static constexpr double TWO_PI = 2.0 * 3.141592653589793238;
+    static constexpr int RENORMALIZATION_INTERVAL = 256;
+
+    double phase = 0.0;
+    double sinVal = 0.0;
+    double cosVal = 1.0;
+    double angleDelta = 0.0;
+    double sinDelta = 0.0;
+    double cosDelta = 1.0;
+    int numStepsSinceRenormalization = 0;
+
+    void renormalize()
+    {
+        // A Newton step of 1 / sqrt (x) around 1.0, which is enough for the tiny drift
+        const double gain = 1.5 - 0.5 * (sinVal * sinVal + cosVal * cosVal);
+        sinVal *= gain;
+        cosVal *= gain;
+        numStepsSinceRenormalization = 0;
+    }
+};
+} // namespace onsen
@@ -20,8 +20,16 @@ class IChorusParams
 {
 public:
     virtual bool getChorusOn() const = 0;
+    virtual int getNumTaps() const = 0;
 };
 
+//==============================================================================
+namespace ChorusConfig
+{
+    // 1 is the classic mono chorus, more make a stereo ensemble
+    static constexpr int MAX_NUM_TAPS = 8;
+}
+
 //==============================================================================
 class ChorusParams : public IChorusParams
 {
@@ -37,21 +45,39 @@ public:
         chorusOnVal = *chorusOn;
     }
 
+    int getNumTaps() const override
+    {
+        return DspUtil::mapFlnumToInt (chorusEnsembleVal, 0.0, 1.0, 1, ChorusConfig::MAX_NUM_TAPS);
+    }
+
+    void setChorusEnsemblePtr (std::atomic<flnum>* _chorusEnsemble)
+    {
+        chorusEnsemble = _chorusEnsemble;
+        chorusEnsembleVal = *chorusEnsemble;
+    }
+
     void parameterChanged()
     {
         chorusOnVal = *chorusOn;
+        chorusEnsembleVal = *chorusEnsemble;
     }
 
     std::vector<ParamMetaInfo> getParamMetaList()
     {
         constexpr int numDecimal = 4;
         return {
-            { "chorusOn", "Chorus", 0.0, &chorusOn, ParamUtil::valueToOnOffString }
+            { "chorusOn", "Chorus", 0.0, &chorusOn, ParamUtil::valueToOnOffString },
+            { "chorusEnsemble", "Ensemble", 0.0, &chorusEnsemble, [] (float value) {
+                 const int numTaps = DspUtil::mapFlnumToInt (value, 0.0, 1.0, 1, ChorusConfig::MAX_NUM_TAPS);
+                 return numTaps == 1 ? std::string ("OFF") : std::to_string (numTaps) + " taps";
+             } }
         };
     }
 
 private:
     std::atomic<flnum>* chorusOn {};
     flnum chorusOnVal = 0.0;
+    std::atomic<flnum>* chorusEnsemble {};
+    flnum chorusEnsembleVal = 0.0;
 };
 } // namespace onsen
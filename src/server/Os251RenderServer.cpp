@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+   OS-251 render server
+
+   Renders previews for other processes with warm engines.
+   See RenderProtocol.h for the protocol.
+
+   Usage: Os251_RenderServer (--socket <path> | --stdio) [--presets <.oapack file>]
+                             [--sample-rate <Hz>] [--block-size <samples>]
+                             [--workers <num workers>] [--batch <max batch size>]
+
+  ==============================================================================
+*/
+
+#include "RenderServer.h"
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+onsen::RenderServer* runningServer = nullptr;
+
+void handleSignal (int)
+{
+    if (runningServer != nullptr)
+        runningServer->stop();
+}
+
+int printUsage (const char* command)
+{
+    std::cerr << "Usage: " << command << " (--socket <path> | --stdio) [--presets <.oapack file>]"
+              << " [--sample-rate <Hz>] [--block-size <samples>] [--workers <num workers>] [--batch <max batch size>]" << std::endl;
+    return 1;
+}
+} // namespace
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    onsen::RenderServer::Config config;
+    std::string socketPath;
+    std::string packPath;
+    bool useStdio = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp (argv[i], "--socket") == 0 && hasValue)
+            socketPath = argv[++i];
+        else if (std::strcmp (argv[i], "--stdio") == 0)
+            useStdio = true;
+        else if (std::strcmp (argv[i], "--presets") == 0 && hasValue)
+            packPath = argv[++i];
+        else if (std::strcmp (argv[i], "--sample-rate") == 0 && hasValue)
+            config.sampleRate = std::atof (argv[++i]);
+        else if (std::strcmp (argv[i], "--block-size") == 0 && hasValue)
+            config.maxSamplesPerBlock = std::atoi (argv[++i]);
+        else if (std::strcmp (argv[i], "--workers") == 0 && hasValue)
+            config.numWorkers = std::atoi (argv[++i]);
+        else if (std::strcmp (argv[i], "--batch") == 0 && hasValue)
+            config.maxBatchSize = std::atoi (argv[++i]);
+        else
+            return printUsage (argv[0]);
+    }
+    if (useStdio == ! socketPath.empty() || config.sampleRate <= 0.0 || config.maxSamplesPerBlock <= 0
+        || config.numWorkers <= 0 || config.maxBatchSize <= 0)
+        return printUsage (argv[0]);
+
+    std::vector<onsen::PresetBinaryFormat::PackItem> presets;
+    if (! packPath.empty() && ! onsen::RenderServer::readPack (packPath, presets))
+    {
+        std::cerr << "Failed to read " << packPath << std::endl;
+        return 1;
+    }
+
+    // A client which has gone away must not kill the server
+    std::signal (SIGPIPE, SIG_IGN);
+
+    onsen::RenderServer server (config, presets);
+    if (useStdio)
+    {
+        server.serve (STDIN_FILENO, STDOUT_FILENO);
+        return 0;
+    }
+
+    runningServer = &server;
+    std::signal (SIGINT, handleSignal);
+    std::signal (SIGTERM, handleSignal);
+    std::cerr << "Listening on " << socketPath << " with " << presets.size() << " presets" << std::endl;
+    if (! server.listen (socketPath))
+    {
+        std::cerr << "Failed to listen on " << socketPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
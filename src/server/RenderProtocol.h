@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+   Render Protocol
+
+  ==============================================================================
+*/
+
+/*
+Binary protocol of Os251_RenderServer.
+A client sends requests over a Unix domain socket or the server's stdin and
+receives responses in the same stream.
+
+Request
+============================
+RequestHeader   324 bytes
+Event[n]        8 bytes each (n = numEvents)
+============================
+
+Response
+============================
+ResponseHeader  24 bytes
+Audio           float32 * numChannels * numSamples, only if shmName is empty
+============================
+
+Audio is planar: all the samples of channel 0, then channel 1.
+If a request has shmName, the client creates a POSIX shared memory object
+with that name which has at least numChannels * numSamples floats, and the
+server renders directly into it. Nothing follows the response header then.
+The name must be "/" followed by 1 to MAX_SHM_NAME_LENGTH - 1 characters
+without "/", and not "/." or "/..". Other names are a bad request.
+
+Requests are rendered in parallel, so responses may come in a different order
+from requests. Match them by requestId.
+All the numbers are in the host's byte order since both ends are on the same machine.
+*/
+
+#pragma once
+
+#include "../services/PresetBinaryFormat.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+namespace onsen
+{
+//==============================================================================
+namespace RenderProtocol
+{
+    static constexpr int MAX_NUM_CHANNELS = 2;
+    static constexpr std::uint32_t MAX_NUM_SAMPLES = 1 << 22; // About 87 seconds at 48 kHz
+    static constexpr std::uint32_t MAX_NUM_EVENTS = 1 << 16;
+    static constexpr int MAX_SHM_NAME_LENGTH = 63; // Without the null terminator
+
+    enum Status : std::int32_t
+    {
+        ok = 0,
+        badRequest = -1,
+        unknownPreset = -2,
+        sharedMemoryError = -3
+    };
+
+    struct RequestHeader
+    {
+        char magic[4]; // "OARQ"
+        std::uint32_t requestId;
+        std::uint32_t numSamples;
+        std::uint16_t numChannels;
+        std::uint16_t reserved;
+        std::uint32_t numEvents;
+        // Path of the preset in the server's preset pack. Empty for the default parameters.
+        char presetPath[PresetBinaryFormat::MAX_PATH_LENGTH + 1];
+        // Name for shm_open(), e.g. "/os251-preview-1". Empty to receive audio in the stream.
+        // See isValidShmName().
+        char shmName[MAX_SHM_NAME_LENGTH + 1];
+    };
+
+    // A raw MIDI message of up to 3 bytes
+    struct Event
+    {
+        std::uint32_t sample;
+        std::uint8_t data[3];
+        std::uint8_t numBytes;
+    };
+
+    struct ResponseHeader
+    {
+        char magic[4]; // "OARS"
+        std::uint32_t requestId;
+        std::int32_t status;
+        std::uint32_t numSamples;
+        std::uint16_t numChannels;
+        std::uint16_t reserved;
+        std::uint32_t sampleRate;
+    };
+
+    static_assert (sizeof (RequestHeader) == 324);
+    static_assert (sizeof (Event) == 8);
+    static_assert (sizeof (ResponseHeader) == 24);
+
+    inline constexpr char REQUEST_MAGIC[4] = { 'O', 'A', 'R', 'Q' };
+    inline constexpr char RESPONSE_MAGIC[4] = { 'O', 'A', 'R', 'S' };
+
+    // The name comes from a client, so it may only name an object directly under the shm namespace
+    inline bool isValidShmName (const char (&name)[MAX_SHM_NAME_LENGTH + 1])
+    {
+        const auto length = strnlen (name, sizeof (name));
+        if (length < 2 || length > MAX_SHM_NAME_LENGTH || name[0] != '/')
+            return false;
+        if (std::memchr (name + 1, '/', length - 1) != nullptr)
+            return false;
+        return std::strcmp (name, "/.") != 0 && std::strcmp (name, "/..") != 0;
+    }
+
+    //==============================================================================
+    // Blocking I/O which retries short reads and writes. They return false on EOF or an error.
+
+    inline bool readAll (int fd, void* data, std::size_t size)
+    {
+        auto* p = static_cast<char*> (data);
+        while (size > 0)
+        {
+            const auto n = ::read (fd, p, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= static_cast<std::size_t> (n);
+        }
+        return true;
+    }
+
+    inline bool writeAll (int fd, const void* data, std::size_t size)
+    {
+        const auto* p = static_cast<const char*> (data);
+        while (size > 0)
+        {
+            const auto n = ::write (fd, p, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= static_cast<std::size_t> (n);
+        }
+        return true;
+    }
+} // namespace RenderProtocol
+} // namespace onsen
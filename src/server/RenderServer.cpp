@@ -0,0 +1,367 @@
+/*
+  ==============================================================================
+
+   Render Server
+
+  ==============================================================================
+*/
+
+#include "RenderServer.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+namespace onsen
+{
+namespace
+{
+    template <size_t N>
+    std::string toString (const char (&chars)[N])
+    {
+        return std::string (chars, strnlen (chars, N));
+    }
+} // namespace
+
+//==============================================================================
+RenderServer::RenderServer (const Config& _config, const std::vector<PresetBinaryFormat::PackItem>& _presets)
+    : config (_config)
+{
+    assert (config.numWorkers > 0 && config.maxBatchSize > 0);
+    for (const auto& item : _presets)
+        presets[item.path] = item.record;
+
+    for (int i = 0; i < std::max (1, config.numWorkers); i++)
+        workers.push_back (std::make_unique<Worker> (config));
+    for (auto& worker : workers)
+        worker->thread = std::thread ([this, w = worker.get()] { runWorker (*w); });
+}
+
+RenderServer::~RenderServer()
+{
+    {
+        std::lock_guard<std::mutex> lock (queueMutex);
+        isShuttingDown = true;
+    }
+    queueCondition.notify_all();
+    for (auto& worker : workers)
+        worker->thread.join();
+}
+
+bool RenderServer::readPack (const std::string& packPath, std::vector<PresetBinaryFormat::PackItem>& presets)
+{
+    std::ifstream file (packPath, std::ios::binary);
+    if (! file)
+        return false;
+    const std::vector<char> data ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char>());
+    if (! PresetBinaryFormat::isValidPack (data.data(), data.size()))
+        return false;
+
+    const auto numPresets = PresetBinaryFormat::getNumPresets (data.data());
+    presets.clear();
+    presets.reserve (numPresets);
+    for (std::uint32_t i = 0; i < numPresets; i++)
+    {
+        PresetBinaryFormat::PackItem item;
+        item.path = PresetBinaryFormat::getEntry (data.data(), i)->path;
+        if (! PresetBinaryFormat::readPreset (data.data(), data.size(), i, item.record))
+            return false;
+        presets.push_back (std::move (item));
+    }
+    return true;
+}
+
+//==============================================================================
+void RenderServer::serve (int inFd, int outFd)
+{
+    auto connection = std::make_shared<Connection>();
+    connection->outFd = outFd;
+
+    Job job;
+    std::vector<RenderProtocol::Event> rawEvents;
+    while (readRequest (inFd, job.header, rawEvents))
+    {
+        const auto status = validate (job.header);
+        if (status != RenderProtocol::ok)
+        {
+            respond (*connection, makeResponse (job.header, status), nullptr);
+            continue;
+        }
+
+        const auto presetPath = toString (job.header.presetPath);
+        job.preset = nullptr;
+        if (! presetPath.empty())
+            job.preset = &presets.at (presetPath);
+
+        job.events.clear();
+        for (const auto& e : rawEvents)
+            job.events.push_back (MidiDecoder::decode (e.data, std::min<int> (e.numBytes, 3), static_cast<int> (std::min (e.sample, job.header.numSamples))));
+        std::stable_sort (job.events.begin(), job.events.end(), [] (const MidiEvent& a, const MidiEvent& b) { return a.sample < b.sample; });
+
+        job.connection = connection;
+        {
+            std::lock_guard<std::mutex> lock (connection->pendingMutex);
+            connection->numPending++;
+        }
+        enqueue (std::move (job));
+        job = Job();
+    }
+
+    // The caller may close outFd after this returns
+    std::unique_lock<std::mutex> lock (connection->pendingMutex);
+    connection->pendingCondition.wait (lock, [&connection] { return connection->numPending == 0; });
+}
+
+bool RenderServer::listen (const std::string& socketPath)
+{
+    sockaddr_un address {};
+    if (socketPath.size() >= sizeof (address.sun_path))
+        return false;
+    address.sun_family = AF_UNIX;
+    std::strncpy (address.sun_path, socketPath.c_str(), sizeof (address.sun_path) - 1);
+
+    const int listenFd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+        return false;
+    ::unlink (socketPath.c_str());
+    if (::bind (listenFd, reinterpret_cast<sockaddr*> (&address), sizeof (address)) != 0
+        || ::listen (listenFd, SOMAXCONN) != 0)
+    {
+        ::close (listenFd);
+        return false;
+    }
+
+    // Connections are served on their own threads, which close their sockets
+    std::mutex connectionsMutex;
+    std::condition_variable connectionsCondition;
+    std::vector<int> connectionFds;
+    while (! shouldStopListening.load())
+    {
+        pollfd pfd { listenFd, POLLIN, 0 };
+        if (::poll (&pfd, 1, POLL_INTERVAL_MS) <= 0)
+            continue;
+        const int fd = ::accept (listenFd, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+
+        std::lock_guard<std::mutex> lock (connectionsMutex);
+        connectionFds.push_back (fd);
+        std::thread ([this, fd, &connectionsMutex, &connectionsCondition, &connectionFds] {
+            serve (fd, fd);
+            std::lock_guard<std::mutex> lock (connectionsMutex);
+            connectionFds.erase (std::find (connectionFds.begin(), connectionFds.end(), fd));
+            ::close (fd);
+            connectionsCondition.notify_all();
+        }).detach();
+    }
+
+    ::close (listenFd);
+    ::unlink (socketPath.c_str());
+    // Wake up connections waiting for a request. Pending responses are still written.
+    std::unique_lock<std::mutex> lock (connectionsMutex);
+    for (const auto fd : connectionFds)
+        ::shutdown (fd, SHUT_RD);
+    connectionsCondition.wait (lock, [&connectionFds] { return connectionFds.empty(); });
+    return true;
+}
+
+void RenderServer::stop()
+{
+    shouldStopListening.store (true);
+}
+
+//==============================================================================
+bool RenderServer::readRequest (int inFd, RenderProtocol::RequestHeader& header, std::vector<RenderProtocol::Event>& events)
+{
+    if (! RenderProtocol::readAll (inFd, &header, sizeof (header)))
+        return false;
+    // Without the magic, the stream can't be parsed any more
+    if (std::memcmp (header.magic, RenderProtocol::REQUEST_MAGIC, sizeof (header.magic)) != 0
+        || header.numEvents > RenderProtocol::MAX_NUM_EVENTS)
+        return false;
+    events.resize (header.numEvents);
+    return RenderProtocol::readAll (inFd, events.data(), events.size() * sizeof (RenderProtocol::Event));
+}
+
+RenderProtocol::Status RenderServer::validate (RenderProtocol::RequestHeader& header) const
+{
+    // Make sure strings are terminated
+    header.presetPath[sizeof (header.presetPath) - 1] = '\0';
+    header.shmName[sizeof (header.shmName) - 1] = '\0';
+
+    if (header.numChannels < 1 || header.numChannels > RenderProtocol::MAX_NUM_CHANNELS
+        || header.numSamples < 1 || header.numSamples > RenderProtocol::MAX_NUM_SAMPLES)
+        return RenderProtocol::badRequest;
+    if (header.shmName[0] != '\0' && ! RenderProtocol::isValidShmName (header.shmName))
+        return RenderProtocol::badRequest;
+    const auto presetPath = toString (header.presetPath);
+    if (! presetPath.empty() && presets.count (presetPath) == 0)
+        return RenderProtocol::unknownPreset;
+    return RenderProtocol::ok;
+}
+
+void RenderServer::enqueue (Job&& job)
+{
+    {
+        std::lock_guard<std::mutex> lock (queueMutex);
+        queue.push_back (std::move (job));
+    }
+    queueCondition.notify_one();
+}
+
+bool RenderServer::popBatch (std::vector<Job>& batch)
+{
+    batch.clear();
+    std::unique_lock<std::mutex> lock (queueMutex);
+    queueCondition.wait (lock, [this] { return isShuttingDown || ! queue.empty(); });
+    if (queue.empty())
+        return false;
+
+    const auto batchSize = std::min (queue.size(), static_cast<size_t> (std::max (1, config.maxBatchSize)));
+    std::move (queue.begin(), queue.begin() + static_cast<std::ptrdiff_t> (batchSize), std::back_inserter (batch));
+    queue.erase (queue.begin(), queue.begin() + static_cast<std::ptrdiff_t> (batchSize));
+    return true;
+}
+
+void RenderServer::runWorker (Worker& worker)
+{
+    std::vector<Job> batch;
+    while (popBatch (batch))
+    {
+        // Requests with the same preset are rendered in a row, in the order they came
+        std::stable_sort (batch.begin(), batch.end(), [] (const Job& a, const Job& b) { return std::less<> {}(a.preset, b.preset); });
+        for (auto& job : batch)
+        {
+            render (worker, job);
+            releaseNotes (worker);
+
+            auto& connection = *job.connection;
+            {
+                std::lock_guard<std::mutex> lock (connection.pendingMutex);
+                connection.numPending--;
+            }
+            connection.pendingCondition.notify_all();
+        }
+    }
+}
+
+void RenderServer::render (Worker& worker, Job& job)
+{
+    if (job.preset != worker.preset)
+    {
+        if (job.preset != nullptr)
+            worker.synth.loadPreset (*job.preset);
+        else
+            worker.synth.resetParams();
+        worker.preset = job.preset;
+    }
+    // Even with the same preset, the voices' smoothed values are where the previous request left them
+    worker.synth.reset();
+
+    const auto& header = job.header;
+    const auto numChannels = static_cast<int> (header.numChannels);
+    const auto numSamples = static_cast<int> (header.numSamples);
+    const auto audioSize = static_cast<size_t> (numChannels) * header.numSamples;
+    const auto shmName = toString (header.shmName);
+
+    // Render directly into the client's shared memory, or into the worker's buffer to be sent in the stream
+    flnum* audio = nullptr;
+    void* mapped = MAP_FAILED;
+    int shmFd = -1;
+    if (shmName.empty())
+    {
+        worker.audio.resize (audioSize);
+        audio = worker.audio.data();
+    }
+    else
+    {
+        shmFd = ::shm_open (shmName.c_str(), O_RDWR, 0);
+        struct stat shmStat {};
+        if (shmFd >= 0 && ::fstat (shmFd, &shmStat) == 0 && static_cast<size_t> (shmStat.st_size) >= audioSize * sizeof (flnum))
+            mapped = ::mmap (nullptr, audioSize * sizeof (flnum), PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            if (shmFd >= 0)
+                ::close (shmFd);
+            respond (*job.connection, makeResponse (header, RenderProtocol::sharedMemoryError), nullptr);
+            return;
+        }
+        audio = static_cast<flnum*> (mapped);
+    }
+
+    std::array<flnum*, RenderProtocol::MAX_NUM_CHANNELS> outputs {};
+    for (int ch = 0; ch < numChannels; ch++)
+        outputs[ch] = audio + static_cast<size_t> (ch) * header.numSamples;
+    worker.synth.render (outputs.data(), numChannels, numSamples, job.events.data(), static_cast<int> (job.events.size()));
+
+    if (mapped != MAP_FAILED)
+    {
+        ::munmap (mapped, audioSize * sizeof (flnum));
+        ::close (shmFd);
+        respond (*job.connection, makeResponse (header, RenderProtocol::ok), nullptr);
+    }
+    else
+    {
+        respond (*job.connection, makeResponse (header, RenderProtocol::ok), audio);
+    }
+}
+
+// Notes left by the previous request must not sound in the next one
+void RenderServer::releaseNotes (Worker& worker)
+{
+    auto& synth = worker.synth;
+    synth.handleMidiEvent ({ MidiEvent::Type::sustainPedal, 0, 0, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::sostenutoPedal, 0, 0, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::pitchWheel, 0, 8192, 0 });
+    synth.allNoteOff();
+
+    const int blockSize = synth.getMaxSamplesPerBlock();
+    worker.audio.resize (static_cast<size_t> (blockSize) * HeadlessSynth::MAX_NUM_CHANNELS);
+    std::array<flnum*, HeadlessSynth::MAX_NUM_CHANNELS> outputs {};
+    for (int ch = 0; ch < HeadlessSynth::MAX_NUM_CHANNELS; ch++)
+        outputs[ch] = worker.audio.data() + static_cast<size_t> (ch) * blockSize;
+
+    const auto maxNumBlocks = static_cast<int> (MAX_TAIL_SECONDS * synth.getSampleRate() / blockSize) + 1;
+    for (int block = 0; block < maxNumBlocks; block++)
+    {
+        synth.render (outputs.data(), HeadlessSynth::MAX_NUM_CHANNELS, blockSize);
+        flnum peak = 0.0;
+        for (const auto sample : worker.audio)
+            peak = std::max (peak, std::abs (sample));
+        if (peak < SILENCE_THRESHOLD)
+            break;
+    }
+}
+
+void RenderServer::respond (Connection& connection, const RenderProtocol::ResponseHeader& response, const flnum* audio)
+{
+    std::lock_guard<std::mutex> lock (connection.writeMutex);
+    // A client which has gone away is not an error of the server
+    if (RenderProtocol::writeAll (connection.outFd, &response, sizeof (response)) && audio != nullptr)
+        RenderProtocol::writeAll (connection.outFd, audio, static_cast<size_t> (response.numChannels) * response.numSamples * sizeof (flnum));
+}
+
+RenderProtocol::ResponseHeader RenderServer::makeResponse (const RenderProtocol::RequestHeader& request, RenderProtocol::Status status) const
+{
+    RenderProtocol::ResponseHeader response {};
+    std::memcpy (response.magic, RenderProtocol::RESPONSE_MAGIC, sizeof (response.magic));
+    response.requestId = request.requestId;
+    response.status = status;
+    if (status == RenderProtocol::ok)
+    {
+        response.numSamples = request.numSamples;
+        response.numChannels = request.numChannels;
+    }
+    response.sampleRate = static_cast<std::uint32_t> (config.sampleRate);
+    return response;
+}
+} // namespace onsen
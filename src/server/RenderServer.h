@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+   Render Server
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../services/PresetBinaryFormat.h"
+#include "../synth/HeadlessSynth.h"
+#include "../synth/MidiEvent.h"
+#include "RenderProtocol.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+RenderServer
+
+Renders requests of RenderProtocol with a fixed pool of warm HeadlessSynth
+instances, so that a preview doesn't pay for the startup of a process.
+
+- Every preset of the pack is decoded once at startup
+- Requests from every connection go to one queue. A worker takes up to
+  maxBatchSize requests at once and renders the ones with the same preset
+  in a row, so it loads each preset once per batch.
+- After a response is sent, the worker releases every note and renders the
+  tail away before it takes the next request
+
+POSIX only.
+*/
+class RenderServer
+{
+public:
+    struct Config
+    {
+        double sampleRate = DEFAULT_SAMPLE_RATE;
+        // Block size of the tail which is rendered away between requests
+        int maxSamplesPerBlock = DEFAULT_SAMPLES_PER_BLOCK;
+        int numWorkers = 2;
+        int maxBatchSize = 8;
+    };
+
+    RenderServer (const Config& config, const std::vector<PresetBinaryFormat::PackItem>& presets);
+    ~RenderServer();
+    RenderServer (const RenderServer&) = delete;
+    RenderServer& operator= (const RenderServer&) = delete;
+
+    // Reads every preset in a .oapack file. Returns false if it's not a valid pack.
+    static bool readPack (const std::string& packPath, std::vector<PresetBinaryFormat::PackItem>& presets);
+
+    // Serves requests from `inFd` until EOF and returns after every response is written to `outFd`
+    void serve (int inFd, int outFd);
+    // Accepts connections on a Unix domain socket until stop() is called.
+    // Returns false if the socket can't be opened.
+    bool listen (const std::string& socketPath);
+    // Makes listen() return. It's async-signal-safe.
+    void stop();
+
+private:
+    // A client's stream. Workers write responses to it.
+    struct Connection
+    {
+        int outFd;
+        std::mutex writeMutex;
+        std::mutex pendingMutex;
+        std::condition_variable pendingCondition;
+        int numPending = 0;
+    };
+
+    struct Job
+    {
+        std::shared_ptr<Connection> connection;
+        RenderProtocol::RequestHeader header;
+        // nullptr for the default parameters
+        const PresetBinaryFormat::PresetRecord* preset;
+        std::vector<MidiEvent> events;
+    };
+
+    struct Worker
+    {
+        explicit Worker (const Config& config) : synth (config.sampleRate, config.maxSamplesPerBlock) {}
+
+        HeadlessSynth synth;
+        // The preset loaded to the synth. nullptr for the default parameters.
+        const PresetBinaryFormat::PresetRecord* preset = nullptr;
+        std::vector<flnum> audio;
+        std::thread thread;
+    };
+
+    static constexpr int POLL_INTERVAL_MS = 200;
+    // The tail is rendered away until its peak goes below SILENCE_THRESHOLD or for this long at most
+    static constexpr double MAX_TAIL_SECONDS = 10.0;
+
+    const Config config;
+    std::unordered_map<std::string, PresetBinaryFormat::PresetRecord> presets;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<Job> queue;
+    bool isShuttingDown = false;
+    std::atomic<bool> shouldStopListening { false };
+
+    // Returns false on EOF or if the stream is broken
+    static bool readRequest (int inFd, RenderProtocol::RequestHeader& header, std::vector<RenderProtocol::Event>& events);
+    RenderProtocol::Status validate (RenderProtocol::RequestHeader& header) const;
+    void enqueue (Job&& job);
+    bool popBatch (std::vector<Job>& batch);
+    void runWorker (Worker& worker);
+    void render (Worker& worker, Job& job);
+    void releaseNotes (Worker& worker);
+    // `audio` is sent after the header if it is not nullptr
+    static void respond (Connection& connection, const RenderProtocol::ResponseHeader& response, const flnum* audio);
+    RenderProtocol::ResponseHeader makeResponse (const RenderProtocol::RequestHeader& request, RenderProtocol::Status status) const;
+};
+} // namespace onsen
@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+   Preset Binary Format
+
+  ==============================================================================
+*/
+
+#include "PresetBinaryFormat.h"
+#include <algorithm>
+#include <cstring>
+
+namespace onsen
+{
+//==============================================================================
+namespace PresetBinaryFormat
+{
+    namespace
+    {
+        constexpr char RECORD_MAGIC[4] = { 'O', 'A', 'P', 'B' };
+        constexpr char PACK_MAGIC[4] = { 'O', 'A', 'P', 'K' };
+        constexpr std::size_t RECORD_ALIGNMENT = 8;
+
+        void copyString (char* dst, std::size_t dstSize, const std::string& src)
+        {
+            std::memset (dst, 0, dstSize);
+            std::memcpy (dst, src.data(), std::min (src.size(), dstSize - 1));
+        }
+
+        std::size_t align (std::size_t offset)
+        {
+            return (offset + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+        }
+
+        const PackHeader* packHeader (const void* data)
+        {
+            return static_cast<const PackHeader*> (data);
+        }
+    } // namespace
+
+    //==============================================================================
+    void initRecord (PresetRecord& record, const std::string& savedByVersion)
+    {
+        std::memset (&record, 0, sizeof (PresetRecord));
+        std::memcpy (record.header.magic, RECORD_MAGIC, sizeof (RECORD_MAGIC));
+        record.header.formatVersion = FORMAT_VERSION;
+        record.header.numParams = 0;
+        copyString (record.header.savedByVersion, sizeof (record.header.savedByVersion), savedByVersion);
+    }
+
+    bool setParam (PresetRecord& record, const std::string& paramId, double value)
+    {
+        if (paramId.empty() || paramId.size() > MAX_PARAM_ID_LENGTH)
+            return false;
+
+        for (int i = 0; i < record.header.numParams; i++)
+        {
+            if (paramId == record.params[i].id)
+            {
+                record.params[i].value = value;
+                return true;
+            }
+        }
+
+        if (record.header.numParams >= MAX_NUM_PARAMS)
+            return false;
+
+        auto& entry = record.params[record.header.numParams++];
+        copyString (entry.id, sizeof (entry.id), paramId);
+        entry.value = value;
+        return true;
+    }
+
+    const ParamEntry* findParam (const PresetRecord& record, const std::string& paramId)
+    {
+        for (int i = 0; i < record.header.numParams; i++)
+        {
+            if (paramId == record.params[i].id)
+                return &record.params[i];
+        }
+        return nullptr;
+    }
+
+    bool readRecord (const void* data, std::size_t size, PresetRecord& record)
+    {
+        if (data == nullptr || size < sizeof (Header))
+            return false;
+
+        Header header;
+        std::memcpy (&header, data, sizeof (Header));
+        if (std::memcmp (header.magic, RECORD_MAGIC, sizeof (RECORD_MAGIC)) != 0
+            || header.formatVersion != FORMAT_VERSION
+            || header.numParams > MAX_NUM_PARAMS
+            || header.savedByVersion[MAX_VERSION_LENGTH] != '\0')
+            return false;
+
+        const std::size_t recordSize = sizeof (Header) + header.numParams * sizeof (ParamEntry);
+        if (size < recordSize)
+            return false;
+
+        std::memcpy (&record, data, recordSize);
+        // Make sure every ID is null terminated
+        for (int i = 0; i < header.numParams; i++)
+            record.params[i].id[MAX_PARAM_ID_LENGTH] = '\0';
+        return true;
+    }
+
+    std::vector<std::uint8_t> writeRecord (const PresetRecord& record)
+    {
+        const auto* begin = reinterpret_cast<const std::uint8_t*> (&record);
+        return std::vector<std::uint8_t> (begin, begin + record.size());
+    }
+
+    //==============================================================================
+    std::vector<std::uint8_t> writePack (std::vector<PackItem> items)
+    {
+        for (const auto& item : items)
+        {
+            if (item.path.size() > MAX_PATH_LENGTH)
+                return {};
+        }
+        std::sort (items.begin(), items.end(), [] (const PackItem& a, const PackItem& b) {
+            return a.path < b.path;
+        });
+
+        const auto numPresets = static_cast<std::uint32_t> (items.size());
+        const std::size_t entriesOffset = sizeof (PackHeader);
+        std::size_t recordOffset = align (entriesOffset + numPresets * sizeof (PackEntry));
+
+        std::vector<PackEntry> entries (numPresets);
+        for (std::uint32_t i = 0; i < numPresets; i++)
+        {
+            std::memset (&entries[i], 0, sizeof (PackEntry));
+            copyString (entries[i].path, sizeof (entries[i].path), items[i].path);
+            entries[i].offset = recordOffset;
+            entries[i].size = static_cast<std::uint32_t> (items[i].record.size());
+            recordOffset = align (recordOffset + entries[i].size);
+        }
+
+        std::vector<std::uint8_t> pack (recordOffset, 0);
+        PackHeader header;
+        std::memset (&header, 0, sizeof (PackHeader));
+        std::memcpy (header.magic, PACK_MAGIC, sizeof (PACK_MAGIC));
+        header.formatVersion = FORMAT_VERSION;
+        header.numPresets = numPresets;
+        header.entriesOffset = static_cast<std::uint32_t> (entriesOffset);
+        std::memcpy (pack.data(), &header, sizeof (PackHeader));
+        if (numPresets > 0)
+            std::memcpy (pack.data() + entriesOffset, entries.data(), numPresets * sizeof (PackEntry));
+        for (std::uint32_t i = 0; i < numPresets; i++)
+            std::memcpy (pack.data() + entries[i].offset, &items[i].record, entries[i].size);
+
+        return pack;
+    }
+
+    bool isValidPack (const void* data, std::size_t size)
+    {
+        if (data == nullptr || size < sizeof (PackHeader))
+            return false;
+
+        const auto* header = packHeader (data);
+        if (std::memcmp (header->magic, PACK_MAGIC, sizeof (PACK_MAGIC)) != 0
+            || header->formatVersion != FORMAT_VERSION
+            || header->entriesOffset < sizeof (PackHeader)
+            || header->entriesOffset % alignof (PackEntry) != 0)
+            return false;
+
+        const std::size_t entriesEnd = header->entriesOffset + static_cast<std::size_t> (header->numPresets) * sizeof (PackEntry);
+        if (entriesEnd > size)
+            return false;
+
+        // Paths are read as C strings, so each must be terminated within its field
+        for (std::uint32_t i = 0; i < header->numPresets; i++)
+        {
+            const auto* entry = getEntry (data, i);
+            if (std::memchr (entry->path, '\0', sizeof (entry->path)) == nullptr)
+                return false;
+        }
+        return true;
+    }
+
+    std::uint32_t getNumPresets (const void* data)
+    {
+        return packHeader (data)->numPresets;
+    }
+
+    const PackEntry* getEntry (const void* data, std::uint32_t idx)
+    {
+        if (idx >= getNumPresets (data))
+            return nullptr;
+        const auto* bytes = static_cast<const std::uint8_t*> (data);
+        return reinterpret_cast<const PackEntry*> (bytes + packHeader (data)->entriesOffset) + idx;
+    }
+
+    int findPreset (const void* data, const std::string& path)
+    {
+        // Entries are sorted by path
+        int lo = 0;
+        int hi = static_cast<int> (getNumPresets (data)) - 1;
+        while (lo <= hi)
+        {
+            const int mid = lo + (hi - lo) / 2;
+            const int cmp = std::strncmp (getEntry (data, static_cast<std::uint32_t> (mid))->path, path.c_str(), MAX_PATH_LENGTH + 1);
+            if (cmp == 0)
+                return mid;
+            if (cmp < 0)
+                lo = mid + 1;
+            else
+                hi = mid - 1;
+        }
+        return -1;
+    }
+
+    bool readPreset (const void* data, std::size_t size, std::uint32_t idx, PresetRecord& record)
+    {
+        const auto* entry = getEntry (data, idx);
+        if (entry == nullptr || entry->offset > size || entry->size > size - entry->offset)
+            return false;
+        return readRecord (static_cast<const std::uint8_t*> (data) + entry->offset, entry->size, record);
+    }
+} // namespace PresetBinaryFormat
+} // namespace onsen
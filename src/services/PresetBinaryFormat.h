@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+   Preset Binary Format
+
+  ==============================================================================
+*/
+
+/*
+Compact binary representation of .oapreset files.
+It doesn't depend on JUCE so that it can be used without the plugin.
+
+Preset record (.oapresetb)
+============================
+Header          24 bytes
+ParamEntry[n]   40 bytes each (n <= MAX_NUM_PARAMS)
+============================
+
+Preset pack (.oapack)
+============================
+PackHeader      16 bytes
+PackEntry[m]    256 bytes each, sorted by path
+Preset records  Each one starts at an 8 byte boundary
+============================
+
+The structs are written and read as they are in memory, so the numbers are
+in the byte order of the host. Only little-endian hosts are supported, which
+is checked at compile time, so every file is little endian.
+Every record has a bounded size, so loading a preset from a pack is just
+a memcpy() into PresetRecord.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// MSVC doesn't define __BYTE_ORDER__, but all of its targets are little endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    #error "PresetBinaryFormat supports only little-endian hosts"
+#endif
+
+namespace onsen
+{
+//==============================================================================
+namespace PresetBinaryFormat
+{
+    static constexpr std::uint16_t FORMAT_VERSION = 1;
+    static constexpr int MAX_NUM_PARAMS = 64;
+    static constexpr int MAX_PARAM_ID_LENGTH = 31; // Without the null terminator
+    static constexpr int MAX_VERSION_LENGTH = 15; // Without the null terminator
+    static constexpr int MAX_PATH_LENGTH = 239; // Without the null terminator
+
+    struct Header
+    {
+        char magic[4]; // "OAPB"
+        std::uint16_t formatVersion;
+        std::uint16_t numParams;
+        char savedByVersion[MAX_VERSION_LENGTH + 1];
+    };
+
+    struct ParamEntry
+    {
+        char id[MAX_PARAM_ID_LENGTH + 1];
+        // Stored as double so that values written by juce::var survive a round trip
+        double value;
+    };
+
+    struct PresetRecord
+    {
+        Header header;
+        ParamEntry params[MAX_NUM_PARAMS];
+
+        // Size of the record in a file
+        std::size_t size() const
+        {
+            return sizeof (Header) + header.numParams * sizeof (ParamEntry);
+        }
+    };
+
+    struct PackHeader
+    {
+        char magic[4]; // "OAPK"
+        std::uint16_t formatVersion;
+        std::uint16_t reserved;
+        std::uint32_t numPresets;
+        std::uint32_t entriesOffset;
+    };
+
+    struct PackEntry
+    {
+        // Relative path from the preset folder with '/' as a separator
+        char path[MAX_PATH_LENGTH + 1];
+        std::uint64_t offset;
+        std::uint32_t size;
+        std::uint32_t reserved;
+    };
+
+    static_assert (sizeof (Header) == 24);
+    static_assert (sizeof (ParamEntry) == 40);
+    static_assert (sizeof (PackHeader) == 16);
+    static_assert (sizeof (PackEntry) == 256);
+    static_assert (std::is_trivially_copyable_v<PresetRecord>);
+    static constexpr std::size_t MAX_RECORD_SIZE = sizeof (Header) + MAX_NUM_PARAMS * sizeof (ParamEntry);
+
+    //==============================================================================
+    // Preset record
+
+    void initRecord (PresetRecord& record, const std::string& savedByVersion);
+
+    // Returns false if the record is full or the ID is too long.
+    // If the ID already exists, its value is overwritten.
+    bool setParam (PresetRecord& record, const std::string& paramId, double value);
+
+    // Returns nullptr if not found
+    const ParamEntry* findParam (const PresetRecord& record, const std::string& paramId);
+
+    // Validates the header and copies at most MAX_RECORD_SIZE bytes.
+    bool readRecord (const void* data, std::size_t size, PresetRecord& record);
+
+    std::vector<std::uint8_t> writeRecord (const PresetRecord& record);
+
+    //==============================================================================
+    // Preset pack
+
+    struct PackItem
+    {
+        std::string path;
+        PresetRecord record;
+    };
+
+    // Returns an empty vector if a path is too long
+    std::vector<std::uint8_t> writePack (std::vector<PackItem> items);
+
+    // Returns false if the data is not a valid pack.
+    // It checks only the header and the entry table, so records are not read.
+    bool isValidPack (const void* data, std::size_t size);
+
+    // Following functions expect `data` has passed isValidPack()
+    std::uint32_t getNumPresets (const void* data);
+    const PackEntry* getEntry (const void* data, std::uint32_t idx);
+    // Binary search by path. Returns -1 if not found.
+    int findPreset (const void* data, const std::string& path);
+    bool readPreset (const void* data, std::size_t size, std::uint32_t idx, PresetRecord& record);
+} // namespace PresetBinaryFormat
+} // namespace onsen
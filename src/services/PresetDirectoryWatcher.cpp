@@ -0,0 +1,309 @@
+/*
+  ==============================================================================
+
+   Preset Directory Watcher
+
+  ==============================================================================
+*/
+
+#include "PresetDirectoryWatcher.h"
+
+#if JUCE_LINUX
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+    #include <unordered_map>
+#endif
+
+namespace onsen
+{
+//==============================================================================
+PresetDirectoryWatcher::PresetDirectoryWatcher (juce::File _dir, Mode _mode)
+    : juce::Thread ("OS-251 Preset Directory Watcher"),
+      dir (std::move (_dir)),
+      mode (_mode),
+      changes(),
+      snapshot()
+{
+}
+
+PresetDirectoryWatcher::~PresetDirectoryWatcher()
+{
+    // Stop the thread first, so that nothing triggers an update after it's cancelled
+    signalThreadShouldExit();
+    notify();
+    stopThread (1000);
+    cancelPendingUpdate();
+}
+
+void PresetDirectoryWatcher::start()
+{
+    if (! isThreadRunning())
+        startThread();
+}
+
+bool PresetDirectoryWatcher::isReady() const
+{
+    return ready.load();
+}
+
+std::vector<PresetDirectoryWatcher::Change> PresetDirectoryWatcher::takeChanges()
+{
+    std::lock_guard<std::mutex> lock (changesMutex);
+    std::vector<Change> taken;
+    taken.swap (changes);
+    return taken;
+}
+
+bool PresetDirectoryWatcher::waitUntilReady (int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32> (timeoutMs);
+    while (! isReady())
+    {
+        if (juce::Time::getMillisecondCounter() > deadline)
+            return false;
+        juce::Thread::sleep (1);
+    }
+    return true;
+}
+
+bool PresetDirectoryWatcher::waitUntilChanged (int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock (changesMutex);
+    return changesUpdated.wait_for (lock, std::chrono::milliseconds (timeoutMs), [this] { return ! changes.empty(); });
+}
+
+bool PresetDirectoryWatcher::waitUntilChecked (int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock (changesMutex);
+    // The check in progress might have started before the call
+    const int target = numChecks + 2;
+    return changesUpdated.wait_for (lock, std::chrono::milliseconds (timeoutMs), [this, target] { return numChecks >= target; });
+}
+
+//==============================================================================
+void PresetDirectoryWatcher::run()
+{
+#if JUCE_LINUX
+    if (mode == Mode::automatic && runInotify())
+        return;
+#endif
+    runPolling();
+}
+
+void PresetDirectoryWatcher::handleAsyncUpdate()
+{
+    if (onChangesAvailable != nullptr)
+        onChangesAvailable();
+}
+
+void PresetDirectoryWatcher::runPolling()
+{
+    snapshot.clear();
+    for (const auto& file : dir.findChildFiles (juce::File::findFiles, true, "*.oapreset"))
+        snapshot[file.getFullPathName()] = getFileState (file);
+    ready = true;
+
+    while (! threadShouldExit())
+    {
+        wait (POLLING_INTERVAL_MS);
+        if (! threadShouldExit())
+            diff (dir);
+        finishCheck();
+    }
+}
+
+#if JUCE_LINUX
+bool PresetDirectoryWatcher::runInotify()
+{
+    const int fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    constexpr uint32_t watchMask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO;
+    std::unordered_map<int, juce::File> dirByWatch;
+    auto addWatch = [&] (const juce::File& d) {
+        const int wd = inotify_add_watch (fd, d.getFullPathName().toRawUTF8(), watchMask);
+        if (wd >= 0)
+            dirByWatch[wd] = d;
+    };
+    auto addWatchesRecursively = [&] (const juce::File& d) {
+        addWatch (d);
+        for (const auto& child : d.findChildFiles (juce::File::findDirectories, true))
+            addWatch (child);
+    };
+
+    // Watch before taking the snapshot so that nothing is missed in between
+    addWatchesRecursively (dir);
+    if (dirByWatch.empty())
+    {
+        close (fd);
+        return false;
+    }
+    snapshot.clear();
+    for (const auto& file : dir.findChildFiles (juce::File::findFiles, true, "*.oapreset"))
+        snapshot[file.getFullPathName()] = getFileState (file);
+    ready = true;
+
+    alignas (inotify_event) char buffer[4096];
+    while (! threadShouldExit())
+    {
+        finishCheck();
+        pollfd pfd { fd, POLLIN, 0 };
+        if (poll (&pfd, 1, INOTIFY_TIMEOUT_MS) <= 0)
+            continue;
+
+        const auto length = read (fd, buffer, sizeof (buffer));
+        if (length <= 0)
+            continue;
+
+        for (char* ptr = buffer; ptr < buffer + length;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*> (ptr);
+            ptr += sizeof (inotify_event) + event->len;
+
+            if ((event->mask & IN_Q_OVERFLOW) != 0)
+            {
+                // Some events are lost. Fall back to a full comparison.
+                addWatchesRecursively (dir);
+                diff (dir);
+                continue;
+            }
+            if ((event->mask & IN_IGNORED) != 0)
+            {
+                dirByWatch.erase (event->wd);
+                continue;
+            }
+            if (event->len == 0 || dirByWatch.count (event->wd) == 0)
+                continue;
+
+            const auto file = dirByWatch[event->wd].getChildFile (juce::String::fromUTF8 (event->name));
+            if (isHidden (file))
+                continue;
+            if ((event->mask & IN_ISDIR) != 0)
+            {
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+                {
+                    // Presets might be copied into the folder before it's watched
+                    addWatchesRecursively (file);
+                    diff (file);
+                }
+                else if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+                {
+                    // A moved folder keeps its watches. Stop watching it with the old path.
+                    for (const auto& [wd, watchedDir] : dirByWatch)
+                    {
+                        if (watchedDir == file || watchedDir.isAChildOf (file))
+                            inotify_rm_watch (fd, wd);
+                    }
+                    removeFilesUnder (file);
+                }
+            }
+            else if (isPresetFile (file))
+            {
+                updateFile (file);
+            }
+        }
+    }
+
+    close (fd);
+    return true;
+}
+#endif
+
+void PresetDirectoryWatcher::diff (const juce::File& subDir)
+{
+    // Removed
+    std::vector<juce::File> removedFiles;
+    const auto prefix = subDir.getFullPathName() + juce::File::getSeparatorString();
+    for (auto it = snapshot.lower_bound (prefix); it != snapshot.end() && it->first.startsWith (prefix); ++it)
+    {
+        juce::File file (it->first);
+        if (! file.existsAsFile())
+            removedFiles.push_back (file);
+    }
+    for (const auto& file : removedFiles)
+        updateFile (file);
+
+    // Added or modified
+    if (subDir.isDirectory())
+    {
+        for (const auto& file : subDir.findChildFiles (juce::File::findFiles, true, "*.oapreset"))
+            updateFile (file);
+    }
+}
+
+void PresetDirectoryWatcher::updateFile (const juce::File& file)
+{
+    const auto path = file.getFullPathName();
+    auto it = snapshot.find (path);
+    if (! file.existsAsFile())
+    {
+        if (it != snapshot.end())
+        {
+            snapshot.erase (it);
+            report (Change::Type::removed, file);
+        }
+        return;
+    }
+
+    const auto state = getFileState (file);
+    if (it == snapshot.end())
+    {
+        snapshot[path] = state;
+        report (Change::Type::added, file);
+    }
+    else if (it->second != state)
+    {
+        it->second = state;
+        report (Change::Type::modified, file);
+    }
+}
+
+void PresetDirectoryWatcher::removeFilesUnder (const juce::File& subDir)
+{
+    const auto prefix = subDir.getFullPathName() + juce::File::getSeparatorString();
+    auto it = snapshot.lower_bound (prefix);
+    while (it != snapshot.end() && it->first.startsWith (prefix))
+    {
+        report (Change::Type::removed, juce::File (it->first));
+        it = snapshot.erase (it);
+    }
+}
+
+void PresetDirectoryWatcher::report (Change::Type type, const juce::File& file)
+{
+    {
+        std::lock_guard<std::mutex> lock (changesMutex);
+        changes.push_back ({ type, file });
+    }
+    changesUpdated.notify_all();
+    triggerAsyncUpdate();
+}
+
+void PresetDirectoryWatcher::finishCheck()
+{
+    {
+        std::lock_guard<std::mutex> lock (changesMutex);
+        numChecks++;
+    }
+    changesUpdated.notify_all();
+}
+
+PresetDirectoryWatcher::FileState PresetDirectoryWatcher::getFileState (const juce::File& file)
+{
+    return { file.getLastModificationTime(), file.getSize() };
+}
+
+bool PresetDirectoryWatcher::isPresetFile (const juce::File& file)
+{
+    return file.hasFileExtension (".oapreset");
+}
+
+bool PresetDirectoryWatcher::isHidden (const juce::File& file)
+{
+    // Ignored by juce::File::findChildFiles() too.
+    // e.g. juce::File::replaceWithText() writes a hidden temporary file first.
+    return file.getFileName().startsWithChar ('.');
+}
+} // namespace onsen
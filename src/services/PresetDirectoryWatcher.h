@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+   Preset Directory Watcher
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+PresetDirectoryWatcher
+
+Watches a folder recursively for .oapreset files on a background thread
+and reports what was added, removed or modified since it started.
+
+On Linux it uses inotify. On the other platforms, or if inotify is not
+available, it compares snapshots of the folder at regular intervals.
+
+Changes made before the watcher takes its first snapshot are not reported.
+*/
+class PresetDirectoryWatcher : private juce::Thread,
+                               private juce::AsyncUpdater
+{
+public:
+    enum class Mode
+    {
+        automatic, // inotify if available, otherwise polling
+        polling
+    };
+
+    struct Change
+    {
+        enum class Type
+        {
+            added,
+            removed,
+            modified
+        };
+
+        Type type;
+        juce::File file;
+    };
+
+    explicit PresetDirectoryWatcher (juce::File dir, Mode mode = Mode::automatic);
+    ~PresetDirectoryWatcher() override;
+
+    void start();
+    bool isReady() const;
+    // Takes changes reported so far. It's thread-safe.
+    std::vector<Change> takeChanges();
+
+    // Called on the message thread when new changes are available
+    std::function<void()> onChangesAvailable;
+
+    // For tests
+    bool waitUntilReady (int timeoutMs);
+    // Returns true when there are changes to take
+    bool waitUntilChanged (int timeoutMs);
+    // Returns true when the folder has been checked at least once after the call
+    bool waitUntilChecked (int timeoutMs);
+
+private:
+    static constexpr int POLLING_INTERVAL_MS = 1000;
+    static constexpr int INOTIFY_TIMEOUT_MS = 100;
+
+    struct FileState
+    {
+        juce::Time lastModified;
+        juce::int64 size;
+
+        bool operator!= (const FileState& other) const
+        {
+            return lastModified != other.lastModified || size != other.size;
+        }
+    };
+
+    const juce::File dir;
+    const Mode mode;
+    std::atomic<bool> ready { false };
+
+    std::mutex changesMutex;
+    std::condition_variable changesUpdated;
+    std::vector<Change> changes;
+    // Times the thread has finished looking at the folder. Guarded by changesMutex.
+    int numChecks = 0;
+
+    // Owned by the watcher thread. Full path name -> state
+    std::map<juce::String, FileState> snapshot;
+
+    //==============================================================================
+    void run() override;
+    void handleAsyncUpdate() override;
+    void runPolling();
+#if JUCE_LINUX
+    bool runInotify();
+#endif
+    // Compares the files under the folder with the snapshot and reports the differences
+    void diff (const juce::File& subDir);
+    void updateFile (const juce::File& file);
+    void removeFilesUnder (const juce::File& subDir);
+    void report (Change::Type type, const juce::File& file);
+    void finishCheck();
+    static FileState getFileState (const juce::File& file);
+    static bool isPresetFile (const juce::File& file);
+    static bool isHidden (const juce::File& file);
+};
+} // namespace onsen
@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+   Preset Index
+
+  ==============================================================================
+*/
+
+#include "PresetIndex.h"
+#include <algorithm>
+#include <iterator>
+
+namespace onsen
+{
+//==============================================================================
+namespace
+{
+    // Scores of a term
+    constexpr int NAME_PREFIX_SCORE = 100;
+    constexpr int NAME_WORD_PREFIX_SCORE = 60;
+    constexpr int NAME_SUBSTRING_SCORE = 40;
+    constexpr int FOLDER_WORD_PREFIX_SCORE = 20;
+    constexpr int FOLDER_SUBSTRING_SCORE = 10;
+
+    bool isWordChar (char c)
+    {
+        const auto u = static_cast<unsigned char> (c);
+        // Keep non-ASCII bytes so that UTF-8 names are searchable as they are
+        return u >= 0x80 || (u >= '0' && u <= '9') || (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z');
+    }
+
+    // Returns true if term is found at the beginning of a word in text
+    bool containsWordPrefix (const std::string& text, const std::string& term)
+    {
+        for (auto pos = text.find (term); pos != std::string::npos; pos = text.find (term, pos + 1))
+        {
+            if (pos == 0 || ! isWordChar (text[pos - 1]))
+                return true;
+        }
+        return false;
+    }
+} // namespace
+
+//==============================================================================
+void PresetIndex::clear()
+{
+    entries.clear();
+    postings.clear();
+    words.clear();
+    wordsSorted = true;
+}
+
+int PresetIndex::add (const std::string& name, const std::string& folder)
+{
+    const int id = static_cast<int> (entries.size());
+    entries.push_back ({ normalize (name), normalize (folder) });
+    const auto& entry = entries.back();
+
+    addTrigrams (entry.name, id);
+    addTrigrams (entry.folder, id);
+    for (const auto* field : { &entry.name, &entry.folder })
+    {
+        for (auto& word : splitIntoWords (*field))
+            words.emplace_back (std::move (word), id);
+    }
+    wordsSorted = false;
+    return id;
+}
+
+int PresetIndex::size() const
+{
+    return static_cast<int> (entries.size());
+}
+
+std::vector<PresetIndex::Result> PresetIndex::search (const std::string& query, int maxResults) const
+{
+    auto terms = splitIntoWords (normalize (query));
+    if (terms.empty() || maxResults <= 0)
+        return {};
+
+    // The longest term is usually the most selective one
+    std::sort (terms.begin(), terms.end(), [] (const std::string& a, const std::string& b) {
+        return a.size() > b.size();
+    });
+
+    std::vector<Result> results;
+    for (const int id : findCandidates (terms[0]))
+    {
+        int score = 0;
+        for (const auto& term : terms)
+        {
+            const int termScore = scoreTerm (entries[static_cast<size_t> (id)], term);
+            if (termScore == 0)
+            {
+                score = 0;
+                break;
+            }
+            score += termScore;
+        }
+        if (score > 0)
+            results.push_back ({ id, score });
+    }
+
+    const auto numResults = std::min (results.size(), static_cast<size_t> (maxResults));
+    std::partial_sort (results.begin(), results.begin() + static_cast<long> (numResults), results.end(), [] (const Result& a, const Result& b) {
+        return a.score != b.score ? a.score > b.score : a.id < b.id;
+    });
+    results.resize (numResults);
+    return results;
+}
+
+//==============================================================================
+std::string PresetIndex::normalize (const std::string& text)
+{
+    std::string normalized (text);
+    for (auto& c : normalized)
+    {
+        if (c >= 'A' && c <= 'Z')
+            c = static_cast<char> (c - 'A' + 'a');
+    }
+    return normalized;
+}
+
+std::vector<std::string> PresetIndex::splitIntoWords (const std::string& normalizedText)
+{
+    std::vector<std::string> result;
+    std::string word;
+    for (const char c : normalizedText)
+    {
+        if (isWordChar (c))
+        {
+            word += c;
+        }
+        else if (! word.empty())
+        {
+            result.push_back (std::move (word));
+            word.clear();
+        }
+    }
+    if (! word.empty())
+        result.push_back (std::move (word));
+    return result;
+}
+
+std::uint32_t PresetIndex::trigramAt (const std::string& text, size_t pos)
+{
+    return static_cast<std::uint32_t> (static_cast<unsigned char> (text[pos])) << 16
+           | static_cast<std::uint32_t> (static_cast<unsigned char> (text[pos + 1])) << 8
+           | static_cast<std::uint32_t> (static_cast<unsigned char> (text[pos + 2]));
+}
+
+void PresetIndex::addTrigrams (const std::string& text, int id)
+{
+    for (size_t pos = 0; pos + TRIGRAM_LENGTH <= text.size(); pos++)
+    {
+        auto& ids = postings[trigramAt (text, pos)];
+        // IDs are added in ascending order, so checking the last one is enough
+        if (ids.empty() || ids.back() != id)
+            ids.push_back (id);
+    }
+}
+
+std::vector<int> PresetIndex::findCandidates (const std::string& term) const
+{
+    if (term.size() < TRIGRAM_LENGTH)
+    {
+        if (! wordsSorted)
+        {
+            std::sort (words.begin(), words.end());
+            wordsSorted = true;
+        }
+
+        std::vector<int> candidates;
+        for (auto it = std::lower_bound (words.begin(), words.end(), std::make_pair (term, -1));
+             it != words.end() && it->first.compare (0, term.size(), term) == 0;
+             ++it)
+            candidates.push_back (it->second);
+        std::sort (candidates.begin(), candidates.end());
+        candidates.erase (std::unique (candidates.begin(), candidates.end()), candidates.end());
+        return candidates;
+    }
+
+    // Intersect posting lists, starting from the shortest one
+    std::vector<const std::vector<int>*> lists;
+    for (size_t pos = 0; pos + TRIGRAM_LENGTH <= term.size(); pos++)
+    {
+        auto it = postings.find (trigramAt (term, pos));
+        if (it == postings.end())
+            return {};
+        lists.push_back (&it->second);
+    }
+    std::sort (lists.begin(), lists.end(), [] (const std::vector<int>* a, const std::vector<int>* b) {
+        return a->size() < b->size();
+    });
+
+    std::vector<int> candidates (*lists[0]);
+    std::vector<int> intersection;
+    for (size_t i = 1; i < lists.size() && ! candidates.empty(); i++)
+    {
+        intersection.clear();
+        std::set_intersection (candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter (intersection));
+        candidates.swap (intersection);
+    }
+    // Trigrams can match without the whole term. scoreTerm() filters them out.
+    return candidates;
+}
+
+int PresetIndex::scoreTerm (const Entry& entry, const std::string& term) const
+{
+    if (entry.name.compare (0, term.size(), term) == 0)
+        return NAME_PREFIX_SCORE;
+    if (containsWordPrefix (entry.name, term))
+        return NAME_WORD_PREFIX_SCORE;
+    // Short terms match only prefixes of words like findCandidates() does.
+    // Otherwise "a" would match almost everything.
+    const bool matchesSubstring = term.size() >= TRIGRAM_LENGTH;
+    if (matchesSubstring && entry.name.find (term) != std::string::npos)
+        return NAME_SUBSTRING_SCORE;
+    if (containsWordPrefix (entry.folder, term))
+        return FOLDER_WORD_PREFIX_SCORE;
+    if (matchesSubstring && entry.folder.find (term) != std::string::npos)
+        return FOLDER_SUBSTRING_SCORE;
+    return 0;
+}
+} // namespace onsen
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+   Preset Index
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+PresetIndex
+
+In-memory search index over preset names and folders.
+It doesn't depend on JUCE.
+
+- Terms with 3 or more characters are looked up in a trigram inverted index
+- Shorter terms are looked up by prefix in a sorted word list, and they
+  match only the beginning of words
+
+Every term in a query must match (AND), and the results are ranked by
+where the terms matched. e.g. the beginning of the name is the best.
+Matching is case-insensitive for ASCII.
+
+It's not thread-safe. search() sorts the word list lazily after add().
+*/
+class PresetIndex
+{
+public:
+    struct Result
+    {
+        // The order in which the preset was added
+        int id;
+        int score;
+    };
+
+    void clear();
+    /*
+    Adds a preset and returns its ID. IDs start from 0.
+    folder is a relative path like "Factory/Bass".
+    */
+    int add (const std::string& name, const std::string& folder);
+    int size() const;
+
+    // Returns at most maxResults results sorted by score
+    std::vector<Result> search (const std::string& query, int maxResults) const;
+
+private:
+    static constexpr int TRIGRAM_LENGTH = 3;
+
+    struct Entry
+    {
+        std::string name; // Normalized
+        std::string folder; // Normalized
+    };
+
+    std::vector<Entry> entries;
+    // Trigram -> sorted IDs
+    std::unordered_map<std::uint32_t, std::vector<int>> postings;
+    // (word, ID) sorted by word. It's sorted lazily.
+    mutable std::vector<std::pair<std::string, int>> words;
+    mutable bool wordsSorted = true;
+
+    //==============================================================================
+    static std::string normalize (const std::string& text);
+    static std::vector<std::string> splitIntoWords (const std::string& normalizedText);
+    static std::uint32_t trigramAt (const std::string& text, size_t pos);
+    void addTrigrams (const std::string& text, int id);
+    std::vector<int> findCandidates (const std::string& term) const;
+    int scoreTerm (const Entry& entry, const std::string& term) const;
+};
+} // namespace onsen
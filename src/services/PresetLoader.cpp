@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+   Preset Loader
+
+  ==============================================================================
+*/
+
+#include "PresetLoader.h"
+#include <algorithm>
+
+namespace onsen
+{
+//==============================================================================
+
+PresetLoader::PresetLoader (Decoder _decoder)
+    : juce::Thread ("OS-251 Preset Loader"),
+      decoder (std::move (_decoder)),
+      requests(),
+      results(),
+      cache(),
+      requestedFiles()
+{
+}
+
+PresetLoader::~PresetLoader()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread (1000);
+}
+
+//==============================================================================
+void PresetLoader::prefetch (const juce::File& file, const juce::String& processorName)
+{
+    collectResults();
+
+    if (file.getFullPathName() == "" || findCached (file) != nullptr || isRequested (file))
+        return;
+
+    // Prefetching is just a hint. If the worker is too busy, give it up.
+    int start1, size1, start2, size2;
+    requestFifo.prepareToWrite (1, start1, size1, start2, size2);
+    if (size1 + size2 == 0)
+        return;
+
+    requests[static_cast<size_t> (size1 > 0 ? start1 : start2)] = { file, processorName, generation };
+    requestedFiles.push_back (file);
+    ++numPendingRequests;
+    requestFifo.finishedWrite (1);
+
+    // Start the thread lazily so that instances which never browse presets
+    // don't have an extra thread.
+    if (! isThreadRunning())
+        startThread();
+    notify();
+}
+
+const PresetLoader::DecodedPreset* PresetLoader::findCached (const juce::File& file)
+{
+    collectResults();
+
+    const int idx = findCacheIdx (file);
+    if (idx < 0)
+        return nullptr;
+
+    // The file might be edited by other tools after it was decoded
+    if (cache[static_cast<size_t> (idx)].lastModified != file.getLastModificationTime())
+    {
+        cache.erase (cache.begin() + idx);
+        return nullptr;
+    }
+
+    // Mark it as the most recently used
+    std::rotate (cache.begin() + idx, cache.begin() + idx + 1, cache.end());
+    return &cache.back();
+}
+
+void PresetLoader::invalidate()
+{
+    ++generation;
+    cache.clear();
+    requestedFiles.clear();
+}
+
+void PresetLoader::invalidate (const juce::File& file)
+{
+    // A result for this file might be on the way, so drop every in-flight result.
+    // Cached presets of the other files are still valid.
+    ++generation;
+    requestedFiles.clear();
+    const int idx = findCacheIdx (file);
+    if (idx >= 0)
+        cache.erase (cache.begin() + idx);
+}
+
+bool PresetLoader::waitUntilIdle (int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32> (timeoutMs);
+    while (numPendingRequests.load() > 0)
+    {
+        if (juce::Time::getMillisecondCounter() > deadline)
+            return false;
+        juce::Thread::sleep (1);
+    }
+    collectResults();
+    return true;
+}
+
+//==============================================================================
+void PresetLoader::run()
+{
+    while (! threadShouldExit())
+    {
+        if (requestFifo.getNumReady() == 0 || resultFifo.getFreeSpace() == 0)
+        {
+            // Wait for a new request, or for the message thread to collect results
+            wait (resultFifo.getFreeSpace() == 0 ? 10 : -1);
+            continue;
+        }
+
+        int start1, size1, start2, size2;
+        requestFifo.prepareToRead (1, start1, size1, start2, size2);
+        Request request = std::move (requests[static_cast<size_t> (size1 > 0 ? start1 : start2)]);
+        requestFifo.finishedRead (1);
+
+        DecodedPreset decoded;
+        decoded.file = request.file;
+        decoded.generation = request.generation;
+        // Read the time before parsing so that an edit made while parsing is detected later
+        decoded.lastModified = request.file.getLastModificationTime();
+        decoded.state = decoder (request.file, request.processorName);
+
+        resultFifo.prepareToWrite (1, start1, size1, start2, size2);
+        results[static_cast<size_t> (size1 > 0 ? start1 : start2)] = std::move (decoded);
+        resultFifo.finishedWrite (1);
+        --numPendingRequests;
+    }
+}
+
+void PresetLoader::collectResults()
+{
+    while (resultFifo.getNumReady() > 0)
+    {
+        int start1, size1, start2, size2;
+        resultFifo.prepareToRead (1, start1, size1, start2, size2);
+        DecodedPreset decoded = std::move (results[static_cast<size_t> (size1 > 0 ? start1 : start2)]);
+        resultFifo.finishedRead (1);
+
+        if (decoded.generation != generation)
+            continue; // Invalidated while it was being decoded
+
+        requestedFiles.erase (std::remove (requestedFiles.begin(), requestedFiles.end(), decoded.file),
+                              requestedFiles.end());
+        if (decoded.state.isValid())
+            addToCache (std::move (decoded));
+    }
+}
+
+void PresetLoader::addToCache (DecodedPreset&& decoded)
+{
+    const int idx = findCacheIdx (decoded.file);
+    if (idx >= 0)
+        cache.erase (cache.begin() + idx);
+    else if (static_cast<int> (cache.size()) >= MAX_CACHED_PRESETS)
+        cache.erase (cache.begin()); // Least recently used
+
+    cache.push_back (std::move (decoded));
+}
+
+int PresetLoader::findCacheIdx (const juce::File& file) const
+{
+    for (size_t i = 0; i < cache.size(); i++)
+    {
+        if (cache[i].file == file)
+            return static_cast<int> (i);
+    }
+    return -1;
+}
+
+bool PresetLoader::isRequested (const juce::File& file) const
+{
+    return std::find (requestedFiles.begin(), requestedFiles.end(), file) != requestedFiles.end();
+}
+} // namespace onsen
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+   Preset Loader
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+PresetLoader
+
+A prefetch cache of decoded presets. It parses preset files on a background
+thread and keeps the decoded states, so that PresetManager can apply a
+prefetched preset without reading or parsing XML on the message thread.
+Applying the state itself still happens on the message thread, and a preset
+which is not cached is parsed there synchronously.
+
+Requests (message thread -> worker) and results (worker -> message thread)
+are passed through single-producer single-consumer FIFOs, so neither side
+ever waits for the other. All the methods except the constructor, the
+destructor and the decoder must be called on the same thread
+(usually the message thread).
+*/
+class PresetLoader : private juce::Thread
+{
+public:
+    struct DecodedPreset
+    {
+        juce::File file;
+        juce::Time lastModified;
+        int generation = 0;
+        // Processor state that is ready to pass to IAudioProcessorState::replaceState()
+        juce::ValueTree state;
+    };
+
+    // Returns an invalid juce::ValueTree if the file can't be decoded.
+    // It's called on the worker thread.
+    using Decoder = std::function<juce::ValueTree (const juce::File& file, const juce::String& processorName)>;
+
+    explicit PresetLoader (Decoder decoder);
+    ~PresetLoader() override;
+
+    /*
+    Asks the worker to decode the file unless it's already cached.
+    processorName is passed to the decoder as it is.
+    */
+    void prefetch (const juce::File& file, const juce::String& processorName);
+
+    /*
+    Returns the decoded preset if it's cached and the file has not been modified
+    since it was decoded. Otherwise returns nullptr.
+    The pointer is valid until the next call of any non-const method.
+    */
+    const DecodedPreset* findCached (const juce::File& file);
+
+    /*
+    Drops everything cached or being decoded.
+    Results of the requests made before this call are ignored.
+    */
+    void invalidate();
+    void invalidate (const juce::File& file);
+
+    // For tests
+    bool waitUntilIdle (int timeoutMs);
+
+private:
+    static constexpr int FIFO_SIZE = 16;
+    static constexpr int MAX_CACHED_PRESETS = 8;
+
+    struct Request
+    {
+        juce::File file;
+        juce::String processorName;
+        int generation = 0;
+    };
+
+    const Decoder decoder;
+
+    juce::AbstractFifo requestFifo { FIFO_SIZE };
+    std::array<Request, FIFO_SIZE> requests;
+    juce::AbstractFifo resultFifo { FIFO_SIZE };
+    std::array<DecodedPreset, FIFO_SIZE> results;
+    std::atomic<int> numPendingRequests { 0 };
+
+    // Owned by the message thread
+    std::vector<DecodedPreset> cache; // The last one is the most recently used
+    std::vector<juce::File> requestedFiles;
+    int generation = 0;
+
+    //==============================================================================
+    void run() override;
+    void collectResults();
+    void addToCache (DecodedPreset&& decoded);
+    int findCacheIdx (const juce::File& file) const;
+    bool isRequested (const juce::File& file) const;
+};
+} // namespace onsen
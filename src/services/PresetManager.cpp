@@ -18,7 +18,10 @@ PresetManager::PresetManager (IAudioProcessorState* _processorState, juce::File
       factoryPresetFiles(),
       userPresetFiles(),
       presetFiles(),
-      currentPresetFile (getDefaultPresetFile())
+      presetIdxByPath(),
+      currentPresetFile (getDefaultPresetFile()),
+      presetLoader (decodePresetFile),
+      presetManifest (presetDir)
 {
     updateCurrentPresetBasedOnProcessorState();
 }
@@ -28,10 +31,23 @@ void PresetManager::scanPresets()
     restorePresetFoldersAndPresetsIfNecessary();
     scanPresets (getFactoryPresetDir(), factoryPresetFiles);
     scanPresets (getUserPresetDir(), userPresetFiles);
+    rebuildPresetList();
+}
+
+void PresetManager::rebuildPresetList()
+{
     presetFiles.clear();
     presetFiles.add (getDefaultPresetFile());
     presetFiles.addArray (factoryPresetFiles);
     presetFiles.addArray (userPresetFiles);
+
+    presetIdxByPath.clear();
+    presetIndex.clear();
+    for (int i = 0; i < presetFiles.size(); i++)
+    {
+        presetIdxByPath[presetFiles[i].getFullPathName().toStdString()] = i;
+        presetIndex.add (getPresetName (presetFiles[i]).toStdString(), getPresetFolder (presetFiles[i]).toStdString());
+    }
 }
 
 juce::File PresetManager::getDefaultPresetFile()
@@ -108,6 +124,7 @@ void PresetManager::savePreset (juce::File file)
     stateContainerXml->addChildElement (stateXml.release());
     presetXml->addChildElement (stateContainerXml.release());
     presetXml->writeTo (file);
+    presetLoader.invalidate (file);
 
     currentPresetFile = file;
 }
@@ -117,6 +134,16 @@ void PresetManager::savePreset (juce::File file)
     */
 void PresetManager::loadPreset (juce::File file)
 {
+    if (auto decoded = presetLoader.findCached (file))
+    {
+        // Apply a copy so that later edits don't modify the cached state
+        processorState->replaceState (decoded->state.createCopy());
+        setPresetNameToProcessorState (file);
+        currentPresetFile = file;
+        prefetchNeighbours (file);
+        return;
+    }
+
     juce::XmlDocument xmlDocument (file);
     std::unique_ptr<juce::XmlElement> presetXml (xmlDocument.getDocumentElement());
 
@@ -125,6 +152,7 @@ void PresetManager::loadPreset (juce::File file)
         loadPresetState (presetXml.get());
         setPresetNameToProcessorState (file);
         currentPresetFile = file;
+        prefetchNeighbours (file);
     }
     else
         loadDefaultFileSafely(); // TODO: change behavior?
@@ -141,12 +169,82 @@ juce::String PresetManager::getPresetName (juce::File file)
     return file.getFileNameWithoutExtension();
 }
 
+juce::String PresetManager::getPresetFolder (const juce::File& file)
+{
+    auto dir = file.getParentDirectory();
+    if (dir == getPresetDir() || ! dir.isAChildOf (getPresetDir()))
+        return "";
+    return dir.getRelativePathFrom (getPresetDir()).replaceCharacter ('\\', '/');
+}
+
+juce::Array<juce::File> PresetManager::searchPresets (const juce::String& query, int maxResults)
+{
+    juce::Array<juce::File> results;
+    for (const auto& result : presetIndex.search (query.toStdString(), maxResults))
+        results.add (presetFiles[result.id]);
+    return results;
+}
+
+void PresetManager::startWatchingPresetDir()
+{
+    if (presetDirWatcher != nullptr)
+        return;
+
+    presetDirWatcher = std::make_unique<PresetDirectoryWatcher> (getPresetDir());
+    presetDirWatcher->onChangesAvailable = [this] {
+        applyPresetFileChanges (presetDirWatcher->takeChanges());
+    };
+    presetDirWatcher->start();
+}
+
+void PresetManager::stopWatchingPresetDir()
+{
+    presetDirWatcher.reset();
+}
+
+void PresetManager::applyPresetFileChanges (const std::vector<PresetDirectoryWatcher::Change>& changes)
+{
+    using ChangeType = PresetDirectoryWatcher::Change::Type;
+    juce::DefaultElementComparator<juce::File> comparator;
+    bool isListChanged = false;
+    for (const auto& change : changes)
+    {
+        // The file might be edited after it was decoded
+        presetLoader.invalidate (change.file);
+
+        // The default preset is always in the list
+        juce::Array<juce::File>* files = nullptr;
+        if (change.file.isAChildOf (getFactoryPresetDir()))
+            files = &factoryPresetFiles;
+        else if (change.file.isAChildOf (getUserPresetDir()))
+            files = &userPresetFiles;
+        else
+            continue;
+
+        if (change.type == ChangeType::added && ! files->contains (change.file))
+        {
+            files->addSorted (comparator, change.file);
+            isListChanged = true;
+        }
+        else if (change.type == ChangeType::removed && files->contains (change.file))
+        {
+            files->removeAllInstancesOf (change.file);
+            isListChanged = true;
+        }
+    }
+
+    if (! isListChanged)
+        return;
+
+    // Rebuilding the list and the index doesn't touch the disk
+    rebuildPresetList();
+    if (onPresetListChanged != nullptr)
+        onPresetListChanged();
+}
+
 void PresetManager::loadPrev()
 {
-    // TODO: If it's slow, Use hash table or binary search. Or cache
-    //       currentPresetFile's index (Note that cached index can't be used
-    //       after presetFiles is updated)
-    int idx = presetFiles.indexOf (currentPresetFile);
+    int idx = findPresetIdx (currentPresetFile);
     if (idx > 0)
         loadPreset (presetFiles[idx - 1]);
     else if (idx < 0) // Usually it doesn't happen
@@ -155,7 +253,7 @@ void PresetManager::loadPrev()
 
 void PresetManager::loadNext()
 {
-    int idx = presetFiles.indexOf (currentPresetFile);
+    int idx = findPresetIdx (currentPresetFile);
     if (idx < presetFiles.size() - 1)
         loadPreset (presetFiles[idx + 1]);
     else if (idx < 0) // Usually it doesn't happen
@@ -175,6 +273,11 @@ bool PresetManager::validatePresetFile (juce::File file)
 }
 
 bool PresetManager::validatePresetXml (juce::XmlElement const* const presetXml)
+{
+    return validatePresetXml (presetXml, processorState->getProcessorName());
+}
+
+bool PresetManager::validatePresetXml (juce::XmlElement const* const presetXml, const juce::String& processorName)
 {
     if (presetXml != nullptr
         && presetXml->hasTagName ("Preset")
@@ -189,12 +292,29 @@ bool PresetManager::validatePresetXml (juce::XmlElement const* const presetXml)
         && presetXml->getChildByName ("Version")->getFirstChildElement()->isTextElement()
         && presetXml->getChildByName ("Version")->getFirstChildElement()->getText() == "0"
         && presetXml->getChildByName ("State") != nullptr
-        && presetXml->getChildByName ("State")->getChildByName (processorState->getProcessorName()) != nullptr)
+        && presetXml->getChildByName ("State")->getChildByName (processorName) != nullptr)
         return true;
 
     return false;
 }
 
+// It's called on PresetLoader's worker thread, so it must not touch
+// the processor state.
+juce::ValueTree PresetManager::decodePresetFile (const juce::File& file, const juce::String& processorName)
+{
+    if (! file.existsAsFile())
+        return {};
+
+    juce::XmlDocument xmlDocument (file);
+    std::unique_ptr<juce::XmlElement> presetXml (xmlDocument.getDocumentElement());
+    if (! validatePresetXml (presetXml.get(), processorName))
+        return {};
+
+    auto state = juce::ValueTree::fromXml (
+        *(presetXml->getChildByName ("State")->getChildByName (processorName)));
+    return fixPresetState (state);
+}
+
 void PresetManager::loadPresetState (juce::XmlElement const* const presetXml)
 {
     auto newState = juce::ValueTree::fromXml (
@@ -307,6 +427,30 @@ juce::File PresetManager::getPresetDir()
     return presetDir;
 }
 
+int PresetManager::findPresetIdx (const juce::File& file) const
+{
+    auto it = presetIdxByPath.find (file.getFullPathName().toStdString());
+    return it != presetIdxByPath.end() ? it->second : -1;
+}
+
+bool PresetManager::waitUntilPrefetched (int timeoutMs)
+{
+    return presetLoader.waitUntilIdle (timeoutMs);
+}
+
+void PresetManager::prefetchNeighbours (const juce::File& file)
+{
+    const int idx = findPresetIdx (file);
+    if (idx < 0)
+        return;
+
+    // Next is more likely to be loaded than prev
+    if (idx < presetFiles.size() - 1)
+        presetLoader.prefetch (presetFiles[idx + 1], processorState->getProcessorName());
+    if (idx > 0)
+        presetLoader.prefetch (presetFiles[idx - 1], processorState->getProcessorName());
+}
+
 juce::Array<juce::File> PresetManager::scanPresets (juce::File dir, juce::Array<juce::File>& presetFiles)
 {
     dir.createDirectory(); // OK if it exists.
@@ -324,10 +468,12 @@ void PresetManager::restorePresetFoldersAndPresetsIfNecessary()
         restoreDefaultPreset();
     }
 
-    // Restore factory preset folder if it doesn't exist.
+    // Restore factory presets if the folder doesn't exist.
+    // Presets which users deleted from the folder stay deleted.
     if (! getFactoryPresetDir().exists() || getFactoryPresetDir().existsAsFile())
     {
-        restoreFactoryPresets();
+        restoreFactoryPresetsIfNecessary();
+        presetManifest.saveIfNeeded();
     }
 
     // Restore user preset folder if it doesn't exist.
@@ -337,37 +483,76 @@ void PresetManager::restorePresetFoldersAndPresetsIfNecessary()
     }
 }
 
-void PresetManager::restoreDefaultPreset()
+void PresetManager::restoreFactoryPresets()
 {
-    auto file = getDefaultPresetFile();
+    restorePresetIfNecessary (getDefaultPresetFile(), BinaryData::Default_oapreset, BinaryData::Default_oapresetSize);
+    restoreFactoryPresetsIfNecessary();
+    presetManifest.saveIfNeeded();
+}
 
-    // Try to delete a folder with the same name as default preset file.
-    // It's OK to use for a file.
-    file.deleteRecursively();
-    // This line will create necessary sub folders
-    file.create();
-    juce::FileOutputStream fs (file);
-    fs.write (BinaryData::Default_oapreset, BinaryData::Default_oapresetSize);
-    fs.flush();
+void PresetManager::restoreDefaultPreset()
+{
+    writePreset (getDefaultPresetFile(), BinaryData::Default_oapreset, BinaryData::Default_oapresetSize);
+    presetManifest.saveIfNeeded();
 }
 
-void PresetManager::restoreFactoryPresets()
+void PresetManager::restoreFactoryPresetsIfNecessary()
 {
     // Try to delete a file with the same name as factory preset folder
     // (Usually it doesn't happen).
-    getFactoryPresetDir().deleteFile();
+    if (getFactoryPresetDir().existsAsFile())
+        getFactoryPresetDir().deleteFile();
 
     auto dir = getFactoryPresetDir();
     for (auto& factoryPreset : factoryPresets)
     {
-        auto dir = getFactoryPresetDir();
         auto file = dir.getChildFile (factoryPreset.path);
-        // This line will create necessary sub folders
-        file.create();
+        restorePresetIfNecessary (file, factoryPreset.data, factoryPreset.size);
+    }
+}
+
+bool PresetManager::restorePresetIfNecessary (const juce::File& file, const char* data, int size)
+{
+    // Usually files are untouched since they were verified or written last time.
+    // In that case, we don't even read them.
+    if (presetManifest.isUntouched (file))
+        return false;
+
+    juce::MemoryBlock content;
+    if (file.existsAsFile() && file.loadFileAsData (content))
+    {
+        const auto contentHash = PresetManifest::hash (content.getData(), content.getSize());
+        const bool isKnownContent = contentHash == presetManifest.getRecordedHash (file)
+                                    || contentHash == PresetManifest::hash (data, static_cast<size_t> (size));
+        // Presets overwritten by users are kept as long as they are valid
+        std::unique_ptr<juce::XmlElement> presetXml;
+        if (! isKnownContent)
+            presetXml = juce::parseXML (content.toString());
+
+        if (isKnownContent || validatePresetXml (presetXml.get(), processorState->getProcessorName()))
+        {
+            presetManifest.record (file, contentHash);
+            return false;
+        }
+    }
+
+    writePreset (file, data, size);
+    return true;
+}
+
+void PresetManager::writePreset (const juce::File& file, const char* data, int size)
+{
+    // Try to delete a folder with the same name as the preset file.
+    // It's OK to use for a file.
+    file.deleteRecursively();
+    // This line will create necessary sub folders
+    file.create();
+    {
         juce::FileOutputStream fs (file);
-        fs.write (factoryPreset.data, factoryPreset.size);
+        fs.write (data, static_cast<size_t> (size));
         fs.flush();
     }
+    presetManifest.record (file, PresetManifest::hash (data, static_cast<size_t> (size)));
 }
 
 void PresetManager::restoreUserPresetFolder()
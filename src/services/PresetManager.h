@@ -10,7 +10,15 @@
 
 #include "../IAudioProcessorState.h"
 #include "FactoryPresets.h"
+#include "PresetDirectoryWatcher.h"
+#include "PresetIndex.h"
+#include "PresetLoader.h"
+#include "PresetManifest.h"
 #include <JuceHeader.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace onsen
 {
@@ -20,6 +28,15 @@ namespace onsen
 PresetManager
 
 Note: scanPresets() need to be called before save/load presets
+
+Presets next to the current one are decoded in the background
+(See PresetLoader), so loadPrev() and loadNext() usually don't
+touch the disk. Other loads, e.g. the first one or a jump, read and
+parse the file synchronously.
+
+While the preset folder is watched (See PresetDirectoryWatcher),
+presets added, removed or modified by other tools are applied to the
+preset list without rescanning.
 */
 class PresetManager
 {
@@ -33,6 +50,13 @@ public:
     juce::Array<juce::File> getFactoryPresets();
     juce::Array<juce::File> getUserPresets();
 
+    /*
+    Writes back the default preset and the factory presets which are missing or broken.
+    Presets which are intact are not rewritten. Call scanPresets() after it.
+    scanPresets() restores them only if the default preset or the Factory folder is missing.
+    */
+    void restoreFactoryPresets();
+
     /*
     Save preset
 
@@ -41,20 +65,39 @@ public:
     void savePreset (juce::File file);
 
     /*
-    Loads preset file. If the file is not found or valid, loads default
+    Loads preset file. If the file is not found or valid, loads default.
+    The state is applied synchronously. The file is read only if it isn't prefetched.
     */
     void loadPreset (juce::File file);
 
     juce::File getCurrentPresetFile();
     static juce::String getPresetName (juce::File file);
+    // Relative path of the preset's folder from the preset folder. e.g. "Factory/Bass"
+    juce::String getPresetFolder (const juce::File& file);
+
+    /*
+    Searches presets by name and folder. Results are sorted by relevance.
+    It uses the index built by scanPresets(), so it doesn't touch the disk.
+    */
+    juce::Array<juce::File> searchPresets (const juce::String& query, int maxResults);
+
+    // onPresetListChanged is called when the watcher changes the preset list
+    void startWatchingPresetDir();
+    void stopWatchingPresetDir();
+    void applyPresetFileChanges (const std::vector<PresetDirectoryWatcher::Change>& changes);
     void loadPrev();
     void loadNext();
     void requireToUpdatePresetNameOnUI();
     static juce::ValueTree fixPresetState (juce::ValueTree& state);
     static juce::ValueTree fixProcessorState (juce::ValueTree& state);
+    static bool validatePresetXml (juce::XmlElement const* const presetXml, const juce::String& processorName);
+
+    // For tests. Waits until the presets next to the current one are decoded.
+    bool waitUntilPrefetched (int timeoutMs);
 
     //==============================================================================
     std::function<void()> onNeedToUpdateUI;
+    std::function<void()> onPresetListChanged;
 
 private:
     IAudioProcessorState* processorState;
@@ -62,19 +105,33 @@ private:
     juce::Array<juce::File> factoryPresetFiles;
     juce::Array<juce::File> userPresetFiles;
     juce::Array<juce::File> presetFiles;
+    // Full path name -> index of presetFiles
+    std::unordered_map<std::string, int> presetIdxByPath;
+    // IDs are indices of presetFiles
+    PresetIndex presetIndex;
     juce::File currentPresetFile;
+    PresetLoader presetLoader;
+    std::unique_ptr<PresetDirectoryWatcher> presetDirWatcher;
+    PresetManifest presetManifest;
     static constexpr float PARAM_EPSILON = 0.0001;
 
     //==============================================================================
     bool validatePresetFile (juce::File file);
     bool validatePresetXml (juce::XmlElement const* const presetXml);
+    static juce::ValueTree decodePresetFile (const juce::File& file, const juce::String& processorName);
     void loadPresetState (juce::XmlElement const* const presetXml);
+    int findPresetIdx (const juce::File& file) const;
+    void prefetchNeighbours (const juce::File& file);
     void loadDefaultFileSafely();
     juce::File getPresetDir();
     juce::Array<juce::File> scanPresets (juce::File dir, juce::Array<juce::File>& presetFiles);
+    void rebuildPresetList();
     void restorePresetFoldersAndPresetsIfNecessary();
     void restoreDefaultPreset();
-    void restoreFactoryPresets();
+    void restoreFactoryPresetsIfNecessary();
+    // Writes the preset only if it's missing or broken. Returns true if it's written.
+    bool restorePresetIfNecessary (const juce::File& file, const char* data, int size);
+    void writePreset (const juce::File& file, const char* data, int size);
     void restoreUserPresetFolder();
     void updateCurrentPresetBasedOnProcessorState();
     static bool isParamValueValid (const juce::var& value);
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+   Preset Manifest
+
+  ==============================================================================
+*/
+
+#include "PresetManifest.h"
+
+namespace onsen
+{
+//==============================================================================
+namespace
+{
+    constexpr auto MANIFEST_FILE_NAME = ".manifest";
+    constexpr auto MANIFEST_HEADER = "OS-251 preset manifest 1";
+} // namespace
+
+//==============================================================================
+PresetManifest::PresetManifest (juce::File _presetDir)
+    : presetDir (std::move (_presetDir)),
+      entries()
+{
+}
+
+juce::uint64 PresetManifest::hash (const void* data, size_t size)
+{
+    constexpr juce::uint64 offsetBasis = 0xcbf29ce484222325ULL;
+    constexpr juce::uint64 prime = 0x100000001b3ULL;
+
+    juce::uint64 h = offsetBasis;
+    const auto* bytes = static_cast<const juce::uint8*> (data);
+    for (size_t i = 0; i < size; i++)
+    {
+        h ^= bytes[i];
+        h *= prime;
+    }
+    return h;
+}
+
+bool PresetManifest::isUntouched (const juce::File& file)
+{
+    loadIfNeeded();
+    auto it = entries.find (toRelativePath (file));
+    if (it == entries.end() || ! file.existsAsFile())
+        return false;
+
+    return it->second.size == file.getSize()
+           && it->second.lastModifiedMs == file.getLastModificationTime().toMilliseconds();
+}
+
+juce::uint64 PresetManifest::getRecordedHash (const juce::File& file)
+{
+    loadIfNeeded();
+    auto it = entries.find (toRelativePath (file));
+    return it != entries.end() ? it->second.hash : 0;
+}
+
+void PresetManifest::record (const juce::File& file, juce::uint64 contentHash)
+{
+    loadIfNeeded();
+    entries[toRelativePath (file)] = { contentHash, file.getSize(), file.getLastModificationTime().toMilliseconds() };
+    isDirty = true;
+}
+
+void PresetManifest::saveIfNeeded()
+{
+    if (! isDirty)
+        return;
+
+    juce::String text;
+    text << MANIFEST_HEADER << "\n";
+    for (const auto& [path, entry] : entries)
+    {
+        text << juce::String::toHexString (static_cast<juce::int64> (entry.hash)) << "\t"
+             << juce::String (entry.size) << "\t"
+             << juce::String (entry.lastModifiedMs) << "\t"
+             << path << "\n";
+    }
+
+    // A broken manifest only makes files verified again, so an error is not critical
+    if (getManifestFile().replaceWithText (text))
+        isDirty = false;
+}
+
+juce::File PresetManifest::getManifestFile() const
+{
+    return presetDir.getChildFile (MANIFEST_FILE_NAME);
+}
+
+//==============================================================================
+void PresetManifest::loadIfNeeded()
+{
+    if (isLoaded)
+        return;
+    isLoaded = true;
+
+    juce::StringArray lines;
+    getManifestFile().readLines (lines);
+    if (lines.isEmpty() || lines[0] != MANIFEST_HEADER)
+        return;
+
+    for (int i = 1; i < lines.size(); i++)
+    {
+        auto tokens = juce::StringArray::fromTokens (lines[i], "\t", "");
+        if (tokens.size() != 4)
+            continue;
+        entries[tokens[3]] = { static_cast<juce::uint64> (tokens[0].getHexValue64()),
+                               tokens[1].getLargeIntValue(),
+                               tokens[2].getLargeIntValue() };
+    }
+}
+
+juce::String PresetManifest::toRelativePath (const juce::File& file) const
+{
+    return file.getRelativePathFrom (presetDir).replaceCharacter ('\\', '/');
+}
+} // namespace onsen
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+   Preset Manifest
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+PresetManifest
+
+Remembers the size, the modification time and the content hash of the
+preset files which PresetManager has verified or written, so that they are
+not read or rewritten while they are untouched.
+
+The manifest is a hidden text file in the preset folder. One line per file:
+<hash>\t<size>\t<modification time in ms>\t<relative path>
+*/
+class PresetManifest
+{
+public:
+    explicit PresetManifest (juce::File presetDir);
+
+    // FNV-1a 64 bit
+    static juce::uint64 hash (const void* data, size_t size);
+
+    // Returns true if the file's size and modification time are the same as recorded
+    bool isUntouched (const juce::File& file);
+    // Returns the recorded hash or 0 if not recorded
+    juce::uint64 getRecordedHash (const juce::File& file);
+    void record (const juce::File& file, juce::uint64 contentHash);
+    // Writes the manifest only if something has been recorded
+    void saveIfNeeded();
+
+    juce::File getManifestFile() const;
+
+private:
+    struct Entry
+    {
+        juce::uint64 hash;
+        juce::int64 size;
+        juce::int64 lastModifiedMs;
+    };
+
+    const juce::File presetDir;
+    std::map<juce::String, Entry> entries; // Relative path -> Entry
+    bool isLoaded = false;
+    bool isDirty = false;
+
+    void loadIfNeeded();
+    juce::String toRelativePath (const juce::File& file) const;
+};
+} // namespace onsen
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+   Preset Pack
+
+  ==============================================================================
+*/
+
+#include "PresetPack.h"
+#include "PresetManager.h"
+
+namespace onsen
+{
+//==============================================================================
+PresetPack::PresetPack (const juce::File& packFile)
+{
+    if (! packFile.existsAsFile())
+        return;
+
+    mappedFile = std::make_unique<juce::MemoryMappedFile> (packFile, juce::MemoryMappedFile::readOnly);
+    valid = PresetBinaryFormat::isValidPack (getData(), getSize());
+}
+
+bool PresetPack::isValid() const
+{
+    return valid;
+}
+
+int PresetPack::getNumPresets() const
+{
+    if (! valid)
+        return 0;
+    return static_cast<int> (PresetBinaryFormat::getNumPresets (getData()));
+}
+
+juce::String PresetPack::getPresetPath (int idx) const
+{
+    if (idx < 0 || idx >= getNumPresets())
+        return "";
+    return juce::String::fromUTF8 (PresetBinaryFormat::getEntry (getData(), static_cast<std::uint32_t> (idx))->path);
+}
+
+int PresetPack::findPreset (const juce::String& presetPath) const
+{
+    if (! valid)
+        return -1;
+    return PresetBinaryFormat::findPreset (getData(), presetPath.toStdString());
+}
+
+bool PresetPack::readPreset (int idx, PresetBinaryFormat::PresetRecord& record) const
+{
+    if (idx < 0 || idx >= getNumPresets())
+        return false;
+    return PresetBinaryFormat::readPreset (getData(), getSize(), static_cast<std::uint32_t> (idx), record);
+}
+
+//==============================================================================
+bool PresetPack::writePack (const juce::File& presetDir, const juce::Array<juce::File>& presets, const juce::File& packFile, const juce::String& processorName)
+{
+    std::vector<PresetBinaryFormat::PackItem> items;
+    items.reserve (static_cast<size_t> (presets.size()));
+    for (const auto& preset : presets)
+    {
+        if (! preset.isAChildOf (presetDir))
+            continue;
+
+        std::unique_ptr<juce::XmlElement> presetXml (juce::XmlDocument (preset).getDocumentElement());
+        PresetBinaryFormat::PackItem item;
+        if (! presetXmlToRecord (presetXml.get(), processorName, item.record))
+            continue;
+
+        item.path = preset.getRelativePathFrom (presetDir).replaceCharacter ('\\', '/').toStdString();
+        items.push_back (std::move (item));
+    }
+
+    const auto pack = PresetBinaryFormat::writePack (std::move (items));
+    if (pack.empty())
+        return false;
+
+    return packFile.replaceWithData (pack.data(), pack.size());
+}
+
+bool PresetPack::presetXmlToRecord (juce::XmlElement const* const presetXml, const juce::String& processorName, PresetBinaryFormat::PresetRecord& record)
+{
+    if (! PresetManager::validatePresetXml (presetXml, processorName))
+        return false;
+
+    const auto savedByVersion = presetXml->getChildByName ("SavedByVersion")->getAllSubText();
+    if (savedByVersion.getNumBytesAsUTF8() > PresetBinaryFormat::MAX_VERSION_LENGTH)
+        return false;
+    PresetBinaryFormat::initRecord (record, savedByVersion.toStdString());
+
+    auto* stateXml = presetXml->getChildByName ("State")->getChildByName (processorName);
+    for (auto* paramXml : stateXml->getChildWithTagNameIterator ("PARAM"))
+    {
+        if (! paramXml->hasAttribute ("id") || ! paramXml->hasAttribute ("value"))
+            return false;
+        if (! PresetBinaryFormat::setParam (record, paramXml->getStringAttribute ("id").toStdString(), paramXml->getDoubleAttribute ("value")))
+            return false;
+    }
+    return true;
+}
+
+std::unique_ptr<juce::XmlElement> PresetPack::recordToPresetXml (const PresetBinaryFormat::PresetRecord& record, const juce::String& processorName)
+{
+    // Same structure as PresetManager::savePreset() writes
+    auto presetXml = std::make_unique<juce::XmlElement> ("Preset");
+
+    auto gadget = new juce::XmlElement ("Gadget");
+    gadget->addTextElement ("OS-251");
+    presetXml->addChildElement (gadget);
+
+    auto savedByVersion = new juce::XmlElement ("SavedByVersion");
+    savedByVersion->addTextElement (juce::String::fromUTF8 (record.header.savedByVersion));
+    presetXml->addChildElement (savedByVersion);
+
+    auto version = new juce::XmlElement ("Version");
+    version->addTextElement ("0");
+    presetXml->addChildElement (version);
+
+    auto state = new juce::XmlElement ("State");
+    state->addChildElement (recordToPresetState (record, processorName).createXml().release());
+    presetXml->addChildElement (state);
+
+    return presetXml;
+}
+
+juce::ValueTree PresetPack::recordToPresetState (const PresetBinaryFormat::PresetRecord& record, const juce::String& processorName)
+{
+    juce::ValueTree state { juce::Identifier (processorName) };
+    for (int i = 0; i < record.header.numParams; i++)
+    {
+        juce::ValueTree param { juce::Identifier ("PARAM") };
+        param.setProperty (juce::Identifier ("id"), juce::String::fromUTF8 (record.params[i].id), nullptr);
+        param.setProperty (juce::Identifier ("value"), record.params[i].value, nullptr);
+        state.appendChild (param, nullptr);
+    }
+    return state;
+}
+
+//==============================================================================
+const void* PresetPack::getData() const
+{
+    return mappedFile != nullptr ? mappedFile->getData() : nullptr;
+}
+
+std::size_t PresetPack::getSize() const
+{
+    return mappedFile != nullptr ? mappedFile->getSize() : 0;
+}
+} // namespace onsen
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+   Preset Pack
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PresetBinaryFormat.h"
+#include <JuceHeader.h>
+#include <memory>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+PresetPack
+
+Read-only view of a preset pack (See PresetBinaryFormat.h).
+The file is memory-mapped, so opening it doesn't read or parse the presets.
+
+It also converts presets between .oapreset and PresetRecord.
+*/
+class PresetPack
+{
+public:
+    explicit PresetPack (const juce::File& packFile);
+
+    bool isValid() const;
+    int getNumPresets() const;
+    // Relative path from the preset folder. e.g. "Factory/Bass/Bass0.oapreset"
+    juce::String getPresetPath (int idx) const;
+    // Returns -1 if not found
+    int findPreset (const juce::String& presetPath) const;
+    bool readPreset (int idx, PresetBinaryFormat::PresetRecord& record) const;
+
+    //==============================================================================
+    // processorName is the name of the state in .oapreset (IAudioProcessorState::getProcessorName())
+
+    /*
+    Packs presets into a file. Presets have to be in presetDir.
+    Invalid presets are skipped.
+    */
+    static bool writePack (const juce::File& presetDir, const juce::Array<juce::File>& presets, const juce::File& packFile, const juce::String& processorName);
+
+    static bool presetXmlToRecord (juce::XmlElement const* const presetXml, const juce::String& processorName, PresetBinaryFormat::PresetRecord& record);
+    static std::unique_ptr<juce::XmlElement> recordToPresetXml (const PresetBinaryFormat::PresetRecord& record, const juce::String& processorName);
+    // Returns the state in the same form as the one in .oapreset.
+    // Pass it to PresetManager::fixPresetState() before loading.
+    static juce::ValueTree recordToPresetState (const PresetBinaryFormat::PresetRecord& record, const juce::String& processorName);
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    bool valid = false;
+
+    const void* getData() const;
+    std::size_t getSize() const;
+};
+} // namespace onsen
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+   DSP Load Meter
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../dsp/DspCommon.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+DspLoadMeter
+
+Measures how much of a block's deadline (its duration) the audio thread spends.
+1.0 means 100%: the block took as long as it plays.
+
+The audio thread calls beginBlock() and endBlock() around the rendering, and
+the UI reads the results through atomics. The peak is kept until the UI pops
+it, so a spike between two repaints is not missed.
+*/
+class DspLoadMeter
+{
+public:
+    void setCurrentPlaybackSampleRate (double newRate)
+    {
+        assert (newRate > 0.0);
+        sampleRate = newRate;
+    }
+
+    //==============================================================================
+    // Audio thread
+    void beginBlock()
+    {
+        blockStart = Clock::now();
+    }
+
+    void endBlock (int numSamples, int numActiveVoices)
+    {
+        const std::chrono::duration<double> elapsed = Clock::now() - blockStart;
+        addBlock (elapsed.count(), numSamples, numActiveVoices);
+    }
+
+    void addBlock (double elapsedSeconds, int numSamples, int numActiveVoices)
+    {
+        if (numSamples <= 0)
+            return;
+        lastLoad = static_cast<flnum> (elapsedSeconds * sampleRate / numSamples);
+
+        auto peak = peakLoad.load (std::memory_order_relaxed);
+        while (lastLoad > peak && ! peakLoad.compare_exchange_weak (peak, lastLoad, std::memory_order_relaxed))
+        {
+        }
+        load.store (lastLoad, std::memory_order_relaxed);
+        voiceCount.store (numActiveVoices, std::memory_order_relaxed);
+    }
+
+    // Load of the last block for the audio thread
+    flnum getLastLoad() const { return lastLoad; }
+
+    //==============================================================================
+    // UI thread
+    flnum getLoad() const { return load.load (std::memory_order_relaxed); }
+    // The peak since the previous call
+    flnum popPeakLoad() { return peakLoad.exchange (0.0, std::memory_order_relaxed); }
+    int getNumActiveVoices() const { return voiceCount.load (std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double sampleRate = DEFAULT_SAMPLE_RATE;
+    Clock::time_point blockStart {};
+    flnum lastLoad = 0.0;
+
+    std::atomic<flnum> load { 0.0 };
+    std::atomic<flnum> peakLoad { 0.0 };
+    std::atomic<int> voiceCount { 0 };
+};
+} // namespace onsen
@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+
+   Engine Telemetry
+
+  ==============================================================================
+*/
+
+/*
+Stage timing of SynthEngine::renderNextBlock().
+
+It's compiled only with OS251_TELEMETRY=1 (cmake -DOS251_TELEMETRY=ON).
+Otherwise EngineTelemetry is empty and every call is optimized away.
+
+The audio thread pushes a BlockTelemetry per renderNextBlock() call into a
+single-producer single-consumer ring, and one thread (UI or a logger) pops them.
+Records are dropped when the ring is full, so the audio thread never waits.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+#ifndef OS251_TELEMETRY
+    #define OS251_TELEMETRY 0
+#endif
+
+namespace onsen
+{
+//==============================================================================
+// Lock-free ring for one producer thread and one consumer thread.
+// Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscRing
+{
+public:
+    static_assert (Capacity > 0 && (Capacity & (Capacity - 1)) == 0);
+    static_assert (std::is_trivially_copyable_v<T>);
+
+    // Producer only. Returns false if the ring is full.
+    bool push (const T& item)
+    {
+        const auto head = writeIdx.load (std::memory_order_relaxed);
+        if (head - readIdx.load (std::memory_order_acquire) == Capacity)
+            return false;
+        items[head & MASK] = item;
+        writeIdx.store (head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false if the ring is empty.
+    bool pop (T& item)
+    {
+        const auto tail = readIdx.load (std::memory_order_relaxed);
+        if (tail == writeIdx.load (std::memory_order_acquire))
+            return false;
+        item = items[tail & MASK];
+        readIdx.store (tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return writeIdx.load (std::memory_order_acquire) - readIdx.load (std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    std::array<T, Capacity> items {};
+    // On separate cache lines so that the threads don't share one
+    alignas (64) std::atomic<size_t> writeIdx { 0 };
+    alignas (64) std::atomic<size_t> readIdx { 0 };
+};
+
+//==============================================================================
+namespace CycleCounter
+{
+    // Cycles of the CPU's timestamp counter, or nanoseconds where there is no such counter
+    inline std::uint64_t now()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        std::uint64_t val;
+        asm volatile ("mrs %0, cntvct_el0" : "=r"(val));
+        return val;
+#else
+        return static_cast<std::uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (
+                                               std::chrono::steady_clock::now().time_since_epoch())
+                                               .count());
+#endif
+    }
+
+    // Measured once against steady_clock. It sleeps for a while, so don't call it on the audio thread.
+    inline double getCyclesPerSecond()
+    {
+        static const double cyclesPerSecond = [] {
+            const auto startTime = std::chrono::steady_clock::now();
+            const auto startCycles = now();
+            std::this_thread::sleep_for (std::chrono::milliseconds (20));
+            const auto endCycles = now();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+            return static_cast<double> (endCycles - startCycles) / elapsed.count();
+        }();
+        return cyclesPerSecond;
+    }
+} // namespace CycleCounter
+
+//==============================================================================
+struct BlockTelemetry
+{
+    enum Stage
+    {
+        lfo,
+        voices,
+        hpf,
+        chorus,
+        masterVolume,
+        numStages
+    };
+
+    // CycleCounter::now() at the beginning of the block
+    std::uint64_t startCycles;
+    std::array<std::uint32_t, numStages> stageCycles;
+    std::uint16_t numSamples;
+    std::uint16_t numActiveVoices;
+    // MIDI events received since the previous block, including pitch-wheel values
+    // which JuceSynthEngineAdapter coalesced into one
+    std::uint16_t numEvents;
+
+    std::uint64_t getTotalCycles() const
+    {
+        std::uint64_t total = 0;
+        for (const auto cycles : stageCycles)
+            total += cycles;
+        return total;
+    }
+};
+
+using TelemetryRing = SpscRing<BlockTelemetry, 1024>;
+
+//==============================================================================
+#if OS251_TELEMETRY
+class EngineTelemetry
+{
+public:
+    static constexpr bool isEnabled = true;
+
+    // nullptr to stop recording. Set it while the audio thread isn't rendering.
+    void setRing (TelemetryRing* _ring) { ring = _ring; }
+
+    void countEvent() { numEvents++; }
+
+    void beginBlock (int numSamples)
+    {
+        current.numSamples = static_cast<std::uint16_t> (numSamples);
+        current.startCycles = CycleCounter::now();
+        lapCycles = current.startCycles;
+    }
+
+    // Ends `stage` which started at the end of the previous one.
+    // A stage can run several times in a block, once per processing quantum.
+    void lap (BlockTelemetry::Stage stage)
+    {
+        const auto cycles = CycleCounter::now();
+        current.stageCycles[stage] += static_cast<std::uint32_t> (cycles - lapCycles);
+        lapCycles = cycles;
+    }
+
+    void endBlock (int numActiveVoices)
+    {
+        current.numActiveVoices = static_cast<std::uint16_t> (numActiveVoices);
+        current.numEvents = numEvents;
+        numEvents = 0;
+        if (ring != nullptr && ! ring->push (current))
+            numDropped.fetch_add (1, std::memory_order_relaxed);
+        current.stageCycles = {};
+    }
+
+    // Records lost because the consumer didn't keep up
+    std::uint32_t getNumDropped() const { return numDropped.load (std::memory_order_relaxed); }
+
+private:
+    TelemetryRing* ring = nullptr;
+    BlockTelemetry current {};
+    std::uint64_t lapCycles = 0;
+    std::uint16_t numEvents = 0;
+    std::atomic<std::uint32_t> numDropped { 0 };
+};
+#else
+class EngineTelemetry
+{
+public:
+    static constexpr bool isEnabled = false;
+
+    void setRing (TelemetryRing*) {}
+    void countEvent() {}
+    void beginBlock (int) {}
+    void lap (BlockTelemetry::Stage) {}
+    void endBlock (int) {}
+    std::uint32_t getNumDropped() const { return 0; }
+};
+#endif
+} // namespace onsen
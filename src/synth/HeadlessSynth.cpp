@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+   Headless Synth
+
+  ==============================================================================
+*/
+
+#include "HeadlessSynth.h"
+#include "../adapters/RawAudioBuffer.h"
+#include <array>
+
+namespace onsen
+{
+//==============================================================================
+HeadlessSynth::HeadlessSynth (double _sampleRate, int _maxSamplesPerBlock)
+    : sampleRate (_sampleRate),
+      maxSamplesPerBlock (_maxSamplesPerBlock),
+      synthParams(),
+      paramMetas (synthParams.getParamMetaList()),
+      paramValues (paramMetas.size()),
+      paramIds(),
+      paramIdxById(),
+      numVoicesValue (OscillatorParams::numVoicesParamBasicMetaInfo().defaultValue),
+      unisonOnValue (OscillatorParams::unisonOnValueBasicMetaInfo().defaultValue),
+      positionInfo(),
+      lfo (synthParams.lfo(), &positionInfo),
+      voices (FancySynthVoice::buildVoices (SynthEngine::getMaxNumVoices(), &synthParams, &lfo)),
+      synth (&synthParams, &positionInfo, &lfo, voices)
+{
+    for (size_t i = 0; i < paramMetas.size(); i++)
+    {
+        *(paramMetas[i].valuePtr) = &(paramValues[i]);
+        paramIdxById[paramMetas[i].paramId] = static_cast<int> (i);
+        paramIds.push_back (paramMetas[i].paramId);
+    }
+    paramIdxById[OscillatorParams::numVoicesParamBasicMetaInfo().paramId] = NUM_VOICES_PARAM_IDX;
+    paramIds.push_back (OscillatorParams::numVoicesParamBasicMetaInfo().paramId);
+    paramIdxById[OscillatorParams::unisonOnValueBasicMetaInfo().paramId] = UNISON_ON_PARAM_IDX;
+    paramIds.push_back (OscillatorParams::unisonOnValueBasicMetaInfo().paramId);
+
+    resetParams();
+    prepareToPlay (sampleRate, maxSamplesPerBlock);
+}
+
+void HeadlessSynth::prepareToPlay (double _sampleRate, int _maxSamplesPerBlock)
+{
+    assert (_sampleRate > 0.0 && _maxSamplesPerBlock > 0);
+    sampleRate = _sampleRate;
+    maxSamplesPerBlock = _maxSamplesPerBlock;
+    synth.setCurrentPlaybackSampleRate (sampleRate);
+}
+
+//==============================================================================
+int HeadlessSynth::getNumParams() const
+{
+    return static_cast<int> (paramIds.size());
+}
+
+const std::string& HeadlessSynth::getParamId (int idx) const
+{
+    assert (0 <= idx && idx < getNumParams());
+    return paramIds[idx];
+}
+
+bool HeadlessSynth::setParam (const std::string& paramId, flnum value)
+{
+    auto it = paramIdxById.find (paramId);
+    if (it == paramIdxById.end())
+        return false;
+
+    value = std::clamp<flnum> (value, 0.0, 1.0);
+    if (it->second == NUM_VOICES_PARAM_IDX)
+    {
+        numVoicesValue = value;
+        synth.setNumberOfVoices (OscillatorParams::convertParamValueToNumVoices (value));
+    }
+    else if (it->second == UNISON_ON_PARAM_IDX)
+    {
+        unisonOnValue = value;
+        synth.setIsUnison (OscillatorParams::convertParamValueToUnisonOn (value));
+    }
+    else
+    {
+        paramValues[it->second] = value;
+        synthParams.parameterChanged();
+    }
+    return true;
+}
+
+bool HeadlessSynth::getParam (const std::string& paramId, flnum& value) const
+{
+    auto it = paramIdxById.find (paramId);
+    if (it == paramIdxById.end())
+        return false;
+
+    if (it->second == NUM_VOICES_PARAM_IDX)
+        value = numVoicesValue;
+    else if (it->second == UNISON_ON_PARAM_IDX)
+        value = unisonOnValue;
+    else
+        value = paramValues[it->second];
+    return true;
+}
+
+void HeadlessSynth::resetParams()
+{
+    for (size_t i = 0; i < paramMetas.size(); i++)
+        paramValues[i] = paramMetas[i].defaultValue;
+    synthParams.parameterChanged();
+    setParam (OscillatorParams::numVoicesParamBasicMetaInfo().paramId, OscillatorParams::numVoicesParamBasicMetaInfo().defaultValue);
+    setParam (OscillatorParams::unisonOnValueBasicMetaInfo().paramId, OscillatorParams::unisonOnValueBasicMetaInfo().defaultValue);
+}
+
+void HeadlessSynth::loadPreset (const PresetBinaryFormat::PresetRecord& record)
+{
+    resetParams();
+    for (int i = 0; i < record.header.numParams && i < PresetBinaryFormat::MAX_NUM_PARAMS; i++)
+        setParam (record.params[i].id, static_cast<flnum> (record.params[i].value));
+}
+
+bool HeadlessSynth::loadPreset (const void* data, size_t size)
+{
+    PresetBinaryFormat::PresetRecord record;
+    if (! PresetBinaryFormat::readRecord (data, size, record))
+        return false;
+    loadPreset (record);
+    return true;
+}
+
+//==============================================================================
+void HeadlessSynth::handleMidiEvent (const MidiEvent& event)
+{
+    synth.handleMidiEvent (event);
+}
+
+void HeadlessSynth::allNoteOff()
+{
+    synth.allNoteOff();
+}
+
+void HeadlessSynth::reset()
+{
+    synth.reset();
+}
+
+void HeadlessSynth::render (flnum* const* outputs, int numChannels, int numSamples, const MidiEvent* events, int numEvents)
+{
+    assert (0 < numChannels && numChannels <= MAX_NUM_CHANNELS);
+    numChannels = std::clamp (numChannels, 1, MAX_NUM_CHANNELS);
+    for (int ch = 0; ch < numChannels; ch++)
+        std::fill_n (outputs[ch], numSamples, 0.0f);
+
+    int eventIdx = 0;
+    int curSample = 0;
+    while (curSample < numSamples)
+    {
+        while (eventIdx < numEvents && std::max (0, events[eventIdx].sample) <= curSample)
+            synth.handleMidiEvent (events[eventIdx++]);
+
+        int nextSample = numSamples;
+        if (eventIdx < numEvents)
+            nextSample = std::min (events[eventIdx].sample, numSamples);
+        renderChunk (outputs, numChannels, curSample, nextSample - curSample);
+        curSample = nextSample;
+    }
+    while (eventIdx < numEvents)
+        synth.handleMidiEvent (events[eventIdx++]);
+}
+
+bool HeadlessSynth::isClipping()
+{
+    return synth.isClipping();
+}
+
+void HeadlessSynth::renderChunk (flnum* const* outputs, int numChannels, int offset, int numSamples)
+{
+    std::array<flnum*, MAX_NUM_CHANNELS> channels {};
+    for (int ch = 0; ch < numChannels; ch++)
+        channels[ch] = outputs[ch] + offset;
+    RawAudioBuffer audioBuffer (channels.data(), numChannels, numSamples);
+    synth.renderNextBlock (&audioBuffer, 0, numSamples);
+}
+} // namespace onsen
@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+   Headless Synth
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../dsp/DspCommon.h"
+#include "../dsp/IPositionInfo.h"
+#include "../dsp/Lfo.h"
+#include "../services/PresetBinaryFormat.h"
+#include "MidiEvent.h"
+#include "SynthEngine.h"
+#include "SynthParams.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace onsen
+{
+//==============================================================================
+
+/*
+HeadlessSynth
+
+SynthEngine with its own parameters, which does not depend on JUCE.
+It's for embedding OS-251 in an audio server or a game runtime.
+
+Parameter values are normalized to [0, 1] like the plugin's ones and
+presets are loaded from PresetBinaryFormat records.
+Nothing is thread-safe. A caller must serialize every call.
+*/
+class HeadlessSynth
+{
+public:
+    static constexpr int MAX_NUM_CHANNELS = 2;
+
+    explicit HeadlessSynth (double sampleRate = DEFAULT_SAMPLE_RATE, int maxSamplesPerBlock = DEFAULT_SAMPLES_PER_BLOCK);
+    HeadlessSynth (const HeadlessSynth&) = delete;
+    HeadlessSynth& operator= (const HeadlessSynth&) = delete;
+
+    // render() takes any number of samples regardless of maxSamplesPerBlock.
+    // It's only kept for callers which render in blocks of their own, e.g. RenderServer's tail flush.
+    void prepareToPlay (double sampleRate, int maxSamplesPerBlock);
+    double getSampleRate() const { return sampleRate; }
+    int getMaxSamplesPerBlock() const { return maxSamplesPerBlock; }
+
+    //==============================================================================
+    // Parameters
+    int getNumParams() const;
+    // `idx` must be in [0, getNumParams())
+    const std::string& getParamId (int idx) const;
+    // Returns false if the ID is unknown
+    bool setParam (const std::string& paramId, flnum value);
+    bool getParam (const std::string& paramId, flnum& value) const;
+    void resetParams();
+    // Parameters which are not in the preset get their default values.
+    // Unknown parameters in the preset are ignored.
+    void loadPreset (const PresetBinaryFormat::PresetRecord& record);
+    // Returns false if the data is not a valid preset record
+    bool loadPreset (const void* data, size_t size);
+
+    void setBpm (flnum bpm) { positionInfo.bpm = bpm; }
+
+    //==============================================================================
+    // MIDI and audio
+    void handleMidiEvent (const MidiEvent& event);
+    void allNoteOff();
+    // Silences every voice at once and snaps smoothed values to the current parameters.
+    // Call it after loadPreset() so the preset's values don't glide in from the previous ones.
+    void reset();
+    // Overwrites `numChannels` buffers with `numSamples` samples.
+    // `events` must be sorted by their sample and they are applied sample-accurately.
+    // Events out of [0, numSamples) are applied at the nearest end.
+    void render (flnum* const* outputs, int numChannels, int numSamples, const MidiEvent* events = nullptr, int numEvents = 0);
+    bool isClipping();
+
+private:
+    struct PositionInfo : public IPositionInfo
+    {
+        flnum getBpm() const override { return bpm; }
+        bool isPlaying() const override { return false; }
+        flnum getPpqPosition() const override { return 0.0; }
+
+        flnum bpm = 120.0;
+    };
+
+    // Parameters which are not in SynthParams
+    static constexpr int NUM_VOICES_PARAM_IDX = -1;
+    static constexpr int UNISON_ON_PARAM_IDX = -2;
+
+    double sampleRate;
+    int maxSamplesPerBlock;
+
+    SynthParams synthParams;
+    std::vector<ParamMetaInfo> paramMetas;
+    std::vector<std::atomic<flnum>> paramValues;
+    std::vector<std::string> paramIds;
+    std::unordered_map<std::string, int> paramIdxById;
+    flnum numVoicesValue;
+    flnum unisonOnValue;
+
+    PositionInfo positionInfo;
+    Lfo lfo;
+    std::vector<std::shared_ptr<ISynthVoice>> voices;
+    SynthEngine synth;
+
+    void renderChunk (flnum* const* outputs, int numChannels, int offset, int numSamples);
+};
+} // namespace onsen
@@ -18,6 +18,9 @@ class ISynthUi
 public:
     virtual ~ISynthUi() = default;
     virtual bool isClipping() = 0;
+    // DSP load where 1.0 is the block's deadline. It's the peak since the previous call.
+    virtual float popPeakDspLoad() = 0;
+    virtual int getNumActiveVoices() = 0;
 };
 
 } // namespace onsen
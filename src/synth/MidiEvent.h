@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+   MIDI event
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace onsen
+{
+//==============================================================================
+// A MIDI message which SynthEngine handles. It does not depend on JUCE.
+struct MidiEvent
+{
+    enum class Type : uint8_t
+    {
+        none, // Not used by SynthEngine
+        noteOn,
+        noteOff,
+        allNotesOff,
+        pitchWheel,
+        sustainPedal,
+        sostenutoPedal
+    };
+
+    Type type = Type::none;
+    int sample = 0;
+    // noteOn, noteOff: note number
+    // pitchWheel: [0, 16383]
+    // sustainPedal, sostenutoPedal: 1 if down, 0 if up
+    int value = 0;
+    // noteOn: velocity [1, 127]
+    int velocity = 0;
+};
+
+//==============================================================================
+// Decodes raw bytes of a MIDI message through jump tables without allocation.
+namespace MidiDecoder
+{
+    using DecodeFunction = MidiEvent (*) (const uint8_t* data, int numBytes, int sample);
+
+    inline MidiEvent ignore (const uint8_t*, int, int sample)
+    {
+        return { MidiEvent::Type::none, sample, 0, 0 };
+    }
+
+    inline MidiEvent noteOff (const uint8_t* data, int numBytes, int sample)
+    {
+        if (numBytes < 3)
+            return ignore (data, numBytes, sample);
+        return { MidiEvent::Type::noteOff, sample, data[1] & 0x7f, 0 };
+    }
+
+    inline MidiEvent noteOn (const uint8_t* data, int numBytes, int sample)
+    {
+        if (numBytes < 3)
+            return ignore (data, numBytes, sample);
+        const int velocity = data[2] & 0x7f;
+        // Note on with zero velocity is note off
+        if (velocity == 0)
+            return { MidiEvent::Type::noteOff, sample, data[1] & 0x7f, 0 };
+        return { MidiEvent::Type::noteOn, sample, data[1] & 0x7f, velocity };
+    }
+
+    // Controller number -> event type
+    inline constexpr std::array<MidiEvent::Type, 128> CONTROLLER_TYPES = [] {
+        std::array<MidiEvent::Type, 128> types {};
+        types[64] = MidiEvent::Type::sustainPedal;
+        types[66] = MidiEvent::Type::sostenutoPedal;
+        types[123] = MidiEvent::Type::allNotesOff;
+        return types;
+    }();
+
+    inline MidiEvent controller (const uint8_t* data, int numBytes, int sample)
+    {
+        if (numBytes < 3)
+            return ignore (data, numBytes, sample);
+        const auto type = CONTROLLER_TYPES[data[1] & 0x7f];
+        // Pedals are down if the value is 64 or more
+        return { type, sample, (data[2] & 0x7f) >= 64 ? 1 : 0, 0 };
+    }
+
+    inline MidiEvent pitchWheel (const uint8_t* data, int numBytes, int sample)
+    {
+        if (numBytes < 3)
+            return ignore (data, numBytes, sample);
+        return { MidiEvent::Type::pitchWheel, sample, (data[1] & 0x7f) | ((data[2] & 0x7f) << 7), 0 };
+    }
+
+    // Upper 4 bits of the status byte -> decoder
+    inline constexpr std::array<DecodeFunction, 16> DECODE_FUNCTIONS = {
+        ignore, ignore, ignore, ignore, ignore, ignore, ignore, ignore, // 0x0 - 0x7 are not status bytes
+        noteOff, // 0x8
+        noteOn, // 0x9
+        ignore, // 0xa Polyphonic key pressure
+        controller, // 0xb
+        ignore, // 0xc Program change
+        ignore, // 0xd Channel pressure
+        pitchWheel, // 0xe
+        ignore, // 0xf System messages
+    };
+
+    inline MidiEvent decode (const uint8_t* data, int numBytes, int sample)
+    {
+        if (data == nullptr || numBytes < 1)
+            return ignore (data, numBytes, sample);
+        return DECODE_FUNCTIONS[data[0] >> 4](data, numBytes, sample);
+    }
+} // namespace MidiDecoder
+} // namespace onsen
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+   Quality Governor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../dsp/DspCommon.h"
+#include <algorithm>
+
+namespace onsen
+{
+//==============================================================================
+// Each level includes the ones above it
+enum class QualityLevel
+{
+    full,
+    coarseControl, // MIDI controllers are applied once per JuceSynthEngineAdapter's control granule
+    cheapOscillators, // Oscillators use approximated waveforms
+    noChorusInterpolation, // Chorus reads its delay line without interpolation
+    stealReleaseTails, // The quietest voices in their release are cut off
+    lowest = stealReleaseTails
+};
+
+//==============================================================================
+
+/*
+QualityGovernor
+
+Steps the quality down when the DSP load of blocks (1.0 is the deadline)
+approaches the deadline, and back up when there is headroom again.
+
+- A level is dropped after `numBlocksToStepDown` blocks in a row reach `stepDownLoad`
+- A level is restored after `numBlocksToStepUp` blocks in a row stay under `stepUpLoad`
+- Blocks between the two thresholds reset both counts
+
+The gap between the thresholds and the long wait before stepping up keep it
+from flapping between levels. It's called on the audio thread and doesn't allocate.
+*/
+class QualityGovernor
+{
+public:
+    struct Config
+    {
+        flnum stepDownLoad = 0.8;
+        flnum stepUpLoad = 0.5;
+        int numBlocksToStepDown = 2;
+        int numBlocksToStepUp = 200;
+        QualityLevel lowestLevel = QualityLevel::lowest;
+    };
+
+    QualityGovernor() = default;
+    explicit QualityGovernor (const Config& config) : config (config) {}
+
+    // Returns the level for the next block
+    QualityLevel update (flnum load)
+    {
+        if (load >= config.stepDownLoad)
+        {
+            numBlocksUnder = 0;
+            if (++numBlocksOver >= config.numBlocksToStepDown)
+            {
+                numBlocksOver = 0;
+                level = std::min (static_cast<int> (config.lowestLevel), level + 1);
+            }
+        }
+        else if (load <= config.stepUpLoad)
+        {
+            numBlocksOver = 0;
+            if (++numBlocksUnder >= config.numBlocksToStepUp)
+            {
+                numBlocksUnder = 0;
+                level = std::max (0, level - 1);
+            }
+        }
+        else
+        {
+            numBlocksOver = 0;
+            numBlocksUnder = 0;
+        }
+        return getLevel();
+    }
+
+    QualityLevel getLevel() const { return static_cast<QualityLevel> (level); }
+
+    void reset()
+    {
+        level = 0;
+        numBlocksOver = 0;
+        numBlocksUnder = 0;
+    }
+
+private:
+    Config config;
+    int level = 0;
+    int numBlocksOver = 0;
+    int numBlocksUnder = 0;
+};
+} // namespace onsen
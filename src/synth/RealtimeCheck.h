@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+   Realtime Check
+
+  ==============================================================================
+*/
+
+/*
+Marks the code which runs on the audio thread, so that tests can catch
+allocations and locks there.
+
+It's compiled only with OS251_REALTIME_CHECKS=1, which the tests turn on.
+Otherwise the scopes are empty and optimized away.
+
+SynthEngine opens an AudioCallbackScope in renderNextBlock() and the MIDI
+handlers. The test executable interposes malloc, operator new and
+pthread_mutex_lock, and calls noteViolation() when they are called inside a
+scope. When the outermost scope closes the handler is called with what
+happened inside it.
+*/
+
+#pragma once
+
+#ifndef OS251_REALTIME_CHECKS
+    #define OS251_REALTIME_CHECKS 0
+#endif
+
+namespace onsen
+{
+namespace RealtimeCheck
+{
+    enum Violation
+    {
+        allocation,
+        deallocation,
+        lock,
+        numViolations
+    };
+
+    // Counts of each violation in the scope which has just closed
+    struct Report
+    {
+        int counts[numViolations];
+        // Name of the outermost scope
+        const char* scopeName;
+    };
+
+    // Called on the thread which closes the scope, after the checks are off again
+    using Handler = void (*) (const Report&);
+
+#if OS251_REALTIME_CHECKS
+    namespace detail
+    {
+        // Trivially initialized so that reading them in malloc doesn't allocate
+        inline thread_local int depth = 0;
+        inline thread_local int suspendDepth = 0;
+        inline thread_local Report report {};
+        inline Handler handler = nullptr;
+    } // namespace detail
+
+    inline bool isInAudioCallback() { return detail::depth > 0 && detail::suspendDepth == 0; }
+
+    // Called by the interposed functions. It must not allocate.
+    inline void noteViolation (Violation violation)
+    {
+        if (isInAudioCallback())
+            detail::report.counts[violation]++;
+    }
+
+    // Set it before any audio thread starts
+    inline void setHandler (Handler handler) { detail::handler = handler; }
+
+    class AudioCallbackScope
+    {
+    public:
+        explicit AudioCallbackScope (const char* name)
+        {
+            if (detail::depth++ == 0)
+                detail::report = { {}, name };
+        }
+
+        ~AudioCallbackScope()
+        {
+            if (--detail::depth > 0)
+                return;
+            const auto finished = detail::report;
+            for (const auto count : finished.counts)
+            {
+                if (count > 0 && detail::handler != nullptr)
+                {
+                    detail::handler (finished);
+                    break;
+                }
+            }
+        }
+
+        AudioCallbackScope (const AudioCallbackScope&) = delete;
+        AudioCallbackScope& operator= (const AudioCallbackScope&) = delete;
+    };
+
+    // Allows allocations inside an AudioCallbackScope, e.g. for logging of mocks
+    class NonRealtimeScope
+    {
+    public:
+        NonRealtimeScope() { detail::suspendDepth++; }
+        ~NonRealtimeScope() { detail::suspendDepth--; }
+
+        NonRealtimeScope (const NonRealtimeScope&) = delete;
+        NonRealtimeScope& operator= (const NonRealtimeScope&) = delete;
+    };
+#else
+    inline bool isInAudioCallback() { return false; }
+    inline void noteViolation (Violation) {}
+    inline void setHandler (Handler) {}
+
+    class AudioCallbackScope
+    {
+    public:
+        explicit AudioCallbackScope (const char*) {}
+    };
+
+    class NonRealtimeScope
+    {
+    public:
+        NonRealtimeScope() {}
+    };
+#endif
+} // namespace RealtimeCheck
+} // namespace onsen
@@ -15,14 +15,21 @@
 #include "../dsp/IPositionInfo.h"
 #include "../dsp/Lfo.h"
 #include "../dsp/MasterVolume.h"
+#include "EngineTelemetry.h"
+#include "MidiEvent.h"
+#include "QualityGovernor.h"
+#include "RealtimeCheck.h"
 #include "SynthParams.h"
 #include "SynthVoice.h"
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <vector>
 
 namespace onsen
 {
+static_assert (ChorusConfig::MAX_NUM_TAPS <= Chorus::MAX_NUM_TAPS);
+
 class SynthEngine
 {
 public:
@@ -46,6 +53,7 @@ public:
           masterVolume (synthParams->master())
     {
         assert (voices.size() == voicesToNote.size());
+        lfo->setSamplesPerBlock (PROCESSING_QUANTUM);
         addPhaseOffsetToVoices();
     }
 
@@ -58,25 +66,23 @@ public:
         hpf.setCurrentPlaybackSampleRate (sampleRate);
         masterVolume.setCurrentPlaybackSampleRate (sampleRate);
     }
-    void setSamplesPerBlock (int samplesPerBlock)
-    {
-        lfo->setSamplesPerBlock (samplesPerBlock);
-    }
 
+    // Blocks of any size are rendered in chunks of PROCESSING_QUANTUM samples
     void renderNextBlock (IAudioBuffer* outputAudio, int startSample, int numSamples)
     {
-        lfo->renderLfo (startSample, numSamples);
-        lfo->renderLfoSync (startSample, numSamples);
-        for (int i = 0; i < getMaxNumVoices(); i++)
-            voices[i]->renderNextBlock (outputAudio, startSample, numSamples);
-        hpf.render (outputAudio, startSample, numSamples);
-        if (params->chorus()->getChorusOn())
-            chorus.render (outputAudio, startSample, numSamples);
-        masterVolume.render (outputAudio, startSample, numSamples);
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::renderNextBlock");
+        telemetry.beginBlock (numSamples);
+        if (qualityLevel >= QualityLevel::stealReleaseTails)
+            stealReleaseTails();
+        for (int pos = startSample; pos < startSample + numSamples; pos += PROCESSING_QUANTUM)
+            renderQuantum (outputAudio, pos, std::min (PROCESSING_QUANTUM, startSample + numSamples - pos));
+        if constexpr (EngineTelemetry::isEnabled)
+            telemetry.endBlock (getNumActiveVoices());
     }
 
     void noteOn (int noteNumber, int intVelocity)
     {
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::noteOn");
         assert (0 <= noteNumber && noteNumber <= 127);
         assert (0 <= intVelocity && intVelocity <= 127);
 
@@ -99,6 +105,7 @@ public:
 
     void noteOff (int noteNumber)
     {
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::noteOff");
         assert (0 <= noteNumber && noteNumber <= 127);
         if (isUnison)
         {
@@ -112,6 +119,7 @@ public:
 
     void allNoteOff()
     {
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::allNoteOff");
         for (int i = 0; i < numVoices; i++)
         {
             voices[i]->stopNote (0.0, true);
@@ -120,8 +128,23 @@ public:
         lfo->allNoteOff();
     }
 
+    // Silences every voice at once and snaps smoothed values to the current parameters.
+    // Rendering after it doesn't depend on what was rendered before, e.g. after a preset change.
+    void reset()
+    {
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::reset");
+        for (int i = 0; i < getMaxNumVoices(); i++)
+        {
+            voices[i]->reset();
+            voicesToNote[i] = INIT_NOTE_NUMBER;
+        }
+        lfo->allNoteOff();
+        hpf.reset();
+    }
+
     void setPitchWheel (int val)
     {
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::setPitchWheel");
         assert (0 <= val && val <= 16383); // Should be treated like a signed 14 bit integer
         pitchBendValue = val;
         for (int i = 0; i < numVoices; i++)
@@ -130,6 +153,7 @@ public:
 
     void setSustainPedalDown (bool val)
     {
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::setSustainPedalDown");
         if (isSustainPedalDown == val)
         {
             return;
@@ -152,6 +176,7 @@ public:
 
     void setSostenutoPedalDown (bool val)
     {
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::setSostenutoPedalDown");
         if (isSostenutoPedalDown == val)
         {
             return;
@@ -186,11 +211,45 @@ public:
         }
     }
 
+    void handleMidiEvent (const MidiEvent& event)
+    {
+        RealtimeCheck::AudioCallbackScope audioCallback ("SynthEngine::handleMidiEvent");
+        telemetry.countEvent();
+        switch (event.type)
+        {
+            case MidiEvent::Type::noteOn:
+                noteOn (event.value, event.velocity);
+                break;
+            case MidiEvent::Type::noteOff:
+                noteOff (event.value);
+                break;
+            case MidiEvent::Type::allNotesOff:
+                allNoteOff();
+                break;
+            case MidiEvent::Type::pitchWheel:
+                setPitchWheel (event.value);
+                break;
+            case MidiEvent::Type::sustainPedal:
+                setSustainPedalDown (event.value != 0);
+                break;
+            case MidiEvent::Type::sostenutoPedal:
+                setSostenutoPedalDown (event.value != 0);
+                break;
+            case MidiEvent::Type::none:
+                break;
+        }
+    }
+
     static constexpr int getMaxNumVoices()
     {
         return OscillatorConfig::MAX_NUM_VOICES;
     }
 
+    static constexpr int getProcessingQuantum()
+    {
+        return PROCESSING_QUANTUM;
+    }
+
     void setNumberOfVoices (int num)
     {
         assert (1 <= num && num <= getMaxNumVoices());
@@ -223,6 +282,44 @@ public:
         return masterVolume.isClipping();
     }
 
+    // How long the output can keep sounding after every note is released
+    double getTailLengthSeconds() const
+    {
+        double tail = params->envelope()->getRelease();
+        if (params->chorus()->getChorusOn())
+            tail += chorus.getTailLengthSeconds();
+        return tail;
+    }
+
+    int getNumActiveVoices()
+    {
+        int num = 0;
+        for (int i = 0; i < getMaxNumVoices(); i++)
+            num += voices[i]->isActive() ? 1 : 0;
+        return num;
+    }
+
+    // Lower levels are cheaper. See QualityGovernor.
+    // QualityLevel::coarseControl is up to the caller which splits blocks at MIDI events.
+    void setQualityLevel (QualityLevel level)
+    {
+        qualityLevel = level;
+        chorus.setInterpolateBufferAccess (level < QualityLevel::noChorusInterpolation);
+        for (int i = 0; i < getMaxNumVoices(); i++)
+            voices[i]->setUseCheapKernels (level >= QualityLevel::cheapOscillators);
+    }
+
+    QualityLevel getQualityLevel() const
+    {
+        return qualityLevel;
+    }
+
+    // Stage timing. It records nothing unless OS251_TELEMETRY is 1.
+    EngineTelemetry& getTelemetry()
+    {
+        return telemetry;
+    }
+
 private:
     int pitchBendValue;
     int numVoices;
@@ -237,6 +334,10 @@ private:
     Hpf hpf;
     Chorus chorus;
     MasterVolume masterVolume;
+    EngineTelemetry telemetry;
+    QualityLevel qualityLevel = QualityLevel::full;
+    // Release tails kept under QualityLevel::stealReleaseTails
+    static constexpr int MAX_NUM_RELEASE_TAILS_UNDER_PRESSURE = 2;
     static constexpr int INIT_PITCHBEND_VALUE = 8192; // no pitchbend
     //  --- for voicesToNote --->
     static constexpr int INIT_NOTE_NUMBER = -1;
@@ -244,6 +345,45 @@ private:
     // <--- for voicesToNote ---
     static constexpr int INIT_NUMBER_OF_VOICES = 1;
 
+    // Scratch buffers like the LFO's hold one quantum, which keeps the working set small
+    void renderQuantum (IAudioBuffer* outputAudio, int startSample, int numSamples)
+    {
+        assert (numSamples <= PROCESSING_QUANTUM);
+        lfo->renderLfo (startSample, numSamples);
+        lfo->renderLfoSync (startSample, numSamples);
+        telemetry.lap (BlockTelemetry::lfo);
+        for (int i = 0; i < getMaxNumVoices(); i++)
+            voices[i]->renderNextBlock (outputAudio, startSample, numSamples);
+        telemetry.lap (BlockTelemetry::voices);
+
+        // Effects are skipped while their input and their state are silent
+        bool isSilent = hpf.isIdle() && isSilentBlock (outputAudio, startSample, numSamples);
+        if (isSilent)
+        {
+            clearBlock (outputAudio, startSample, numSamples);
+            hpf.skip (numSamples);
+        }
+        else
+        {
+            hpf.render (outputAudio, startSample, numSamples);
+        }
+        telemetry.lap (BlockTelemetry::hpf);
+        if (params->chorus()->getChorusOn())
+        {
+            chorus.setNumTaps (params->chorus()->getNumTaps());
+            if (isSilent)
+                isSilent = chorus.renderSilentInput (outputAudio, startSample, numSamples);
+            else
+                chorus.render (outputAudio, startSample, numSamples);
+        }
+        telemetry.lap (BlockTelemetry::chorus);
+        if (isSilent)
+            masterVolume.skip (numSamples);
+        else
+            masterVolume.render (outputAudio, startSample, numSamples);
+        telemetry.lap (BlockTelemetry::masterVolume);
+    }
+
     bool isVoiceAvailable (int voiceId)
     {
         assert (0 <= voiceId && voiceId < getMaxNumVoices());
@@ -353,6 +493,47 @@ private:
         }
     }
 
+    static bool isSilentBlock (IAudioBuffer* audio, int startSample, int numSamples)
+    {
+        for (int ch = 0; ch < audio->getNumChannels(); ch++)
+        {
+            const flnum* samples = audio->getWritePointer (ch);
+            for (int i = startSample; i < startSample + numSamples; i++)
+            {
+                if (std::abs (samples[i]) >= SILENCE_THRESHOLD)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    static void clearBlock (IAudioBuffer* audio, int startSample, int numSamples)
+    {
+        for (int ch = 0; ch < audio->getNumChannels(); ch++)
+            std::fill_n (audio->getWritePointer (ch) + startSample, numSamples, 0.0f);
+    }
+
+    // Cuts off the quietest voices in their release
+    void stealReleaseTails()
+    {
+        while (true)
+        {
+            int numTails = 0;
+            int quietest = -1;
+            for (int i = 0; i < getMaxNumVoices(); i++)
+            {
+                if (voicesToNote[i] != INIT_NOTE_NUMBER || ! voices[i]->isActive())
+                    continue;
+                numTails++;
+                if (quietest < 0 || voices[i]->getAmplitude() < voices[quietest]->getAmplitude())
+                    quietest = i;
+            }
+            if (numTails <= MAX_NUM_RELEASE_TAILS_UNDER_PRESSURE)
+                return;
+            voices[quietest]->cutOff();
+        }
+    }
+
     void addPhaseOffsetToVoices()
     {
         for (int i = 0; i < getMaxNumVoices(); i++)
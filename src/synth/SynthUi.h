@@ -7,6 +7,7 @@
 */
 
 #pragma once
+#include "DspLoadMeter.h"
 #include "ISynthUi.h"
 #include "SynthEngine.h"
 
@@ -15,15 +16,24 @@ namespace onsen
 class SynthUi : public ISynthUi
 {
 public:
-    SynthUi (SynthEngine& synth) : synth (synth) {}
+    SynthUi (SynthEngine& synth, DspLoadMeter& dspLoadMeter) : synth (synth), dspLoadMeter (dspLoadMeter) {}
     ~SynthUi() override = default;
     bool isClipping() override
     {
         return synth.isClipping();
     };
+    float popPeakDspLoad() override
+    {
+        return dspLoadMeter.popPeakLoad();
+    }
+    int getNumActiveVoices() override
+    {
+        return dspLoadMeter.getNumActiveVoices();
+    }
 
 private:
     SynthEngine& synth;
+    DspLoadMeter& dspLoadMeter;
 };
 
 } // namespace onsen
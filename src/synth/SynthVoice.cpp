@@ -66,6 +66,22 @@ void FancySynthVoice::stopNote (float /*velocity*/, bool allowTailOff)
     isNoteOn = false;
 }
 
+void FancySynthVoice::cutOff()
+{
+    smoothedAmp.reset (0.0);
+    angleDelta = 0.0;
+    smoothedAngleDelta.reset (angleDelta);
+    osc.resetState();
+    isNoteOverlapped = false;
+}
+
+void FancySynthVoice::reset()
+{
+    cutOff();
+    filter.resetBuffer();
+    filter.resetFrequency();
+}
+
 void FancySynthVoice::setPitchWheel (int newPitchWheelValue)
 {
     setPitchBend (newPitchWheelValue);
@@ -31,6 +31,15 @@ public:
     virtual void renderNextBlock (IAudioBuffer* outputBuffer, int startSample, int numSamples) = 0;
     virtual void addPhaseOffset (flnum offset) = 0;
     virtual void setDetune (flnum val) = 0;
+    // True while the voice makes sound, including its release
+    virtual bool isActive() = 0;
+    // Current amplitude of the envelope and the velocity
+    virtual flnum getAmplitude() = 0;
+    // Silences the voice at once. Unlike stopNote(), it doesn't release the LFO's note.
+    virtual void cutOff() = 0;
+    // Cuts off the voice and snaps its smoothed values, so the next note doesn't depend on the previous one
+    virtual void reset() = 0;
+    virtual void setUseCheapKernels (bool val) = 0;
 };
 //==============================================================================
 class FancySynthVoice : public ISynthVoice
@@ -87,6 +96,24 @@ public:
         detune = val;
     }
 
+    bool isActive() override
+    {
+        return angleDelta != 0.0 && ! isVoiceOff();
+    }
+
+    flnum getAmplitude() override
+    {
+        return smoothedAmp.get();
+    }
+
+    void cutOff() override;
+    void reset() override;
+
+    void setUseCheapKernels (bool val) override
+    {
+        osc.setUseCheapKernels (val);
+    }
+
 private:
     double sampleRate;
     MasterParams* const p;
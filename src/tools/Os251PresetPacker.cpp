@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+   OS-251 preset packer
+
+   Converts .oapreset files into the binary formats of PresetBinaryFormat.h,
+   which Os251_RenderServer (--presets) and os251_load_preset() read.
+
+   Usage: Os251_PresetPacker pack <preset folder> <.oapack file> [--processor-name <name>]
+          Os251_PresetPacker record <.oapreset file> <.oapresetb file> [--processor-name <name>]
+
+   --processor-name is the name of the state in .oapreset files. It's "OS-251" by default.
+
+  ==============================================================================
+*/
+
+#include "../services/PresetPack.h"
+#include <JuceHeader.h>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+int printUsage (const char* command)
+{
+    std::cerr << "Usage: " << command << " pack <preset folder> <.oapack file> [--processor-name <name>]" << std::endl
+              << "       " << command << " record <.oapreset file> <.oapresetb file> [--processor-name <name>]" << std::endl;
+    return 1;
+}
+
+juce::File toFile (const char* path)
+{
+    return juce::File::getCurrentWorkingDirectory().getChildFile (juce::String::fromUTF8 (path));
+}
+
+int pack (const juce::File& presetDir, const juce::File& packFile, const juce::String& processorName)
+{
+    auto presets = presetDir.findChildFiles (juce::File::findFiles, true, "*.oapreset");
+    // Same order on every file system, so that the same presets make the same pack
+    presets.sort();
+    if (presets.isEmpty() || ! onsen::PresetPack::writePack (presetDir, presets, packFile, processorName))
+    {
+        std::cerr << "Failed to pack presets in " << presetDir.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const onsen::PresetPack written (packFile);
+    std::cerr << "Packed " << written.getNumPresets() << " of " << presets.size() << " presets into "
+              << packFile.getFullPathName() << std::endl;
+    return 0;
+}
+
+int record (const juce::File& presetFile, const juce::File& recordFile, const juce::String& processorName)
+{
+    std::unique_ptr<juce::XmlElement> presetXml (juce::XmlDocument (presetFile).getDocumentElement());
+    onsen::PresetBinaryFormat::PresetRecord presetRecord;
+    if (! onsen::PresetPack::presetXmlToRecord (presetXml.get(), processorName, presetRecord))
+    {
+        std::cerr << presetFile.getFullPathName() << " is not a valid preset" << std::endl;
+        return 1;
+    }
+
+    const auto data = onsen::PresetBinaryFormat::writeRecord (presetRecord);
+    if (! recordFile.replaceWithData (data.data(), data.size()))
+    {
+        std::cerr << "Failed to write " << recordFile.getFullPathName() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+} // namespace
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    if (argc != 4 && argc != 6)
+        return printUsage (argv[0]);
+
+    juce::String processorName ("OS-251");
+    if (argc == 6)
+    {
+        if (std::strcmp (argv[4], "--processor-name") != 0)
+            return printUsage (argv[0]);
+        processorName = juce::String::fromUTF8 (argv[5]);
+    }
+
+    if (std::strcmp (argv[1], "pack") == 0)
+        return pack (toFile (argv[2]), toFile (argv[3]), processorName);
+    if (std::strcmp (argv[1], "record") == 0)
+        return record (toFile (argv[2]), toFile (argv[3]), processorName);
+    return printUsage (argv[0]);
+}
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+   DSP Load View
+
+  ==============================================================================
+*/
+
+#include "DspLoadView.h"
+
+namespace onsen
+{
+//==============================================================================
+DspLoadView::DspLoadView (ISynthUi* synthUi) : synthUi (synthUi)
+{
+    startTimerHz (frameRate);
+}
+
+void DspLoadView::timerCallback()
+{
+    // The peak of the blocks rendered since the previous frame
+    const float newLoad = synthUi->popPeakDspLoad();
+    load = std::max (newLoad, load * decay);
+    if (newLoad >= peakHoldLoad || --peakHoldRemainingFrames <= 0)
+    {
+        peakHoldLoad = newLoad;
+        peakHoldRemainingFrames = peakHoldFrames;
+    }
+    numActiveVoices = synthUi->getNumActiveVoices();
+    repaint();
+}
+
+void DspLoadView::paint (juce::Graphics& g)
+{
+    // DSP 12% (34%) [=====|    ] Voices 4
+    const auto height = static_cast<float> (getHeight());
+    g.setColour (juce::Colour (colors::textColor));
+    g.setFont (12.0f);
+    g.drawText (
+        juce::String ("DSP ") + juce::String (juce::roundToInt (load * 100.0f)) + "% ("
+            + juce::String (juce::roundToInt (peakHoldLoad * 100.0f)) + "%)",
+        juce::Rectangle<float> (margin, 0.0f, loadTextWidth, height),
+        juce::Justification::centredLeft);
+    g.drawText (
+        juce::String ("Voices ") + juce::String (numActiveVoices),
+        juce::Rectangle<float> (margin * 3.0f + loadTextWidth + barWidth, 0.0f, voicesTextWidth, height),
+        juce::Justification::centredLeft);
+
+    // The bar is full at the deadline
+    const auto barX = margin * 2.0f + loadTextWidth;
+    const auto barY = (height - barHeight) / 2.0f;
+    g.setColour (juce::Colour (barBackgroundColorId));
+    g.fillRect (barX, barY, barWidth, barHeight);
+    g.setColour (juce::Colour (peakHoldLoad >= 1.0f ? overloadColorId : barColorId));
+    g.fillRect (barX, barY, barWidth * juce::jlimit (0.0f, 1.0f, load), barHeight);
+    // Peak-hold marker
+    g.fillRect (barX + (barWidth - 1.0f) * juce::jlimit (0.0f, 1.0f, peakHoldLoad), barY, 1.0f, barHeight);
+}
+//==============================================================================
+} // namespace onsen
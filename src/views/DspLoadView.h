@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+   DSP Load View
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../synth/ISynthUi.h"
+#include "colors.h"
+#include <JuceHeader.h>
+
+namespace onsen
+{
+//==============================================================================
+// Shows the DSP load with a peak-hold and the number of active voices
+class DspLoadView : public juce::Component, juce::Timer
+{
+public:
+    DspLoadView (ISynthUi* synthUi);
+    void paint (juce::Graphics& g) override;
+    void resized() override {}
+    void timerCallback() override;
+
+private:
+    //=============================================================================
+    ISynthUi* const synthUi;
+    float load = 0.0f;
+    float peakHoldLoad = 0.0f;
+    int peakHoldRemainingFrames = 0;
+    int numActiveVoices = 0;
+
+    static constexpr int frameRate = 30;
+    static constexpr int peakHoldFrames = frameRate * 2; // 2 seconds
+    // The bar falls by this ratio every frame
+    static constexpr float decay = 0.8f;
+    static constexpr float margin = 5.0f;
+    static constexpr float loadTextWidth = 90.0f;
+    static constexpr float voicesTextWidth = 60.0f;
+    static constexpr float barWidth = 80.0f;
+    static constexpr float barHeight = 6.0f;
+    static constexpr unsigned int barColorId = colors::primaryColor;
+    static constexpr unsigned int overloadColorId = colors::red; // Over the deadline
+    static constexpr unsigned int barBackgroundColorId = colors::primaryColorDark;
+};
+} // namespace onsen
@@ -32,6 +32,8 @@ PresetManagerView::PresetManagerView (PresetManager& _presetManager)
       saveAsItem(),
       goToPresetFolderItem(),
       rescanPresetsItem(),
+      restoreFactoryPresetsItem(),
+      searchPresetsItem(),
       doNothingOnPresetMenuChangeCallback (false)
 {
     setWantsKeyboardFocus (false);
@@ -95,16 +97,40 @@ PresetManagerView::PresetManagerView (PresetManager& _presetManager)
         presetMenuChanged();
     };
 
+    // The search box is shown on the preset menu only while searching
+    searchBox.setColour (juce::TextEditor::backgroundColourId, juce::Colour (colors::backgroundColorDark));
+    searchBox.setColour (juce::TextEditor::textColourId, juce::Colour (colors::textColor));
+    searchBox.setColour (juce::TextEditor::outlineColourId, juce::Colour (colors::textColorDark));
+    searchBox.setColour (juce::TextEditor::focusedOutlineColourId, juce::Colour (colors::textColor));
+    searchBox.setTextToShowWhenEmpty ("Search presets...", juce::Colour (colors::textColorDark));
+    searchBox.setJustification (juce::Justification::centred);
+    searchBox.onReturnKey = [this] {
+        showSearchResults();
+    };
+    searchBox.onEscapeKey = [this] {
+        hideSearchBox();
+    };
+    addChildComponent (searchBox);
+
     loadPresetMenu();
     selectCurrentPreset();
 
     presetManager.onNeedToUpdateUI = [this] {
         selectCurrentPreset();
     };
+
+    // Presets added or removed by other tools show up without rescanning
+    presetManager.onPresetListChanged = [this] {
+        buildPresetMenu();
+        selectCurrentPreset();
+    };
+    presetManager.startWatchingPresetDir();
 }
 
 PresetManagerView::~PresetManagerView()
 {
+    presetManager.stopWatchingPresetDir();
+    presetManager.onPresetListChanged = nullptr;
     presetManager.onNeedToUpdateUI = nullptr;
     prevButton.removeListener (this);
     nextButton.removeListener (this);
@@ -117,6 +143,7 @@ void PresetManagerView::resized()
     prevButton.setBounds (0, 0, height, height);
     nextButton.setBounds (getWidth() * 1 / 8, 0, height, height);
     presetMenu.setBounds (getWidth() * 2 / 8, 0, getWidth() * 4 / 8 + 15, height);
+    searchBox.setBounds (presetMenu.getBounds());
     reloadButton.setBounds (getWidth() * 7 / 8, 0, height, height);
 }
 
@@ -184,9 +211,16 @@ void PresetManagerView::loadPresetMenu()
 {
     // TODO: Need acync IO for scanning presets?
     presetManager.scanPresets();
+    buildPresetMenu();
+}
+
+void PresetManagerView::buildPresetMenu()
+{
     presetMenu.clear (juce::NotificationType::dontSendNotification);
     factoryPresetMenu.clear();
     userPresetMenu.clear();
+    itemIdByPreset.clear();
+    presetByItemId.clear();
     int itemId = 1; // Item ID should start from 1
 
     // Default preset
@@ -260,6 +294,24 @@ void PresetManagerView::loadPresetMenu()
         rescanPresetsClicked();
     };
     presetMenu.getRootMenu()->addItem (rescanPresetsItem);
+
+    // Restore factory presets
+    restoreFactoryPresetsItem.itemID = itemId++;
+    restoreFactoryPresetsItem.text = "Restore Factory Presets";
+    restoreFactoryPresetsItem.action = [this]() {
+        doNothingOnPresetMenuChangeCallback = true;
+        restoreFactoryPresetsClicked();
+    };
+    presetMenu.getRootMenu()->addItem (restoreFactoryPresetsItem);
+
+    // Search presets
+    searchPresetsItem.itemID = itemId++;
+    searchPresetsItem.text = "Search Presets...";
+    searchPresetsItem.action = [this]() {
+        doNothingOnPresetMenuChangeCallback = true;
+        searchPresetsClicked();
+    };
+    presetMenu.getRootMenu()->addItem (searchPresetsItem);
 }
 
 /*
@@ -388,6 +440,59 @@ void PresetManagerView::rescanPresetsClicked()
     selectCurrentPreset();
 }
 
+void PresetManagerView::restoreFactoryPresetsClicked()
+{
+    presetManager.restoreFactoryPresets();
+    loadPresetMenu();
+    selectCurrentPreset();
+}
+
+void PresetManagerView::searchPresetsClicked()
+{
+    selectCurrentPreset();
+    searchBox.clear();
+    searchBox.setVisible (true);
+    searchBox.grabKeyboardFocus();
+}
+
+void PresetManagerView::showSearchResults()
+{
+    // It doesn't touch the disk. See PresetManager::searchPresets().
+    auto results = presetManager.searchPresets (searchBox.getText(), MAX_SEARCH_RESULTS);
+
+    juce::PopupMenu menu;
+    menu.setLookAndFeel (&presetMenuLookAndFeel);
+    if (results.isEmpty())
+        menu.addItem (juce::PopupMenu::Item ("No presets found").setEnabled (false));
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        juce::PopupMenu::Item item;
+        item.itemID = i + 1; // Item ID should start from 1
+        item.text = PresetManager::getPresetName (results[i]);
+        // Shown on the right side of the item
+        item.shortcutKeyDescription = presetManager.getPresetFolder (results[i]);
+        menu.addItem (item);
+    }
+
+    // If nothing is selected, keep the search box so that the query can be refined.
+    // The view might be deleted while the menu is open.
+    menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (&searchBox),
+                        [safeThis = juce::Component::SafePointer<PresetManagerView> (this), results] (int selectedItemId) {
+                            if (safeThis == nullptr || selectedItemId <= 0)
+                                return;
+                            safeThis->presetManager.loadPreset (results[selectedItemId - 1]);
+                            safeThis->hideSearchBox();
+                            safeThis->selectCurrentPreset();
+                        });
+}
+
+void PresetManagerView::hideSearchBox()
+{
+    searchBox.setVisible (false);
+    searchBox.clear();
+}
+
 void PresetManagerView::selectCurrentPreset()
 {
     if (itemIdByPreset.count (presetManager.getCurrentPresetFile()))
@@ -428,6 +533,7 @@ bool PresetManagerView::isPresetOperationItem (int selectedItemId)
         Save as...
         Go to Preset Folder...
         Rescan Presets
+        Restore Factory Presets
         ============================
         */
     return selectedItemId > lastPresetItemId;
@@ -17,6 +17,8 @@ Save
 Save as...
 Go to Preset Folder...
 Rescan Presets
+Restore Factory Presets      <--- Writes back missing or broken ones
+Search Presets...            <--- Shows the search box on the menu
 ============================
 
 Prev, Next, Revert are normal buttons.
@@ -68,6 +70,7 @@ private:
     juce::Image reloadButtonDownImage;
     juce::ImageButton reloadButton;
     juce::ComboBox presetMenu;
+    juce::TextEditor searchBox;
     juce::PopupMenu factoryPresetMenu;
     juce::PopupMenu userPresetMenu;
     std::unique_ptr<juce::FileChooser> chooser;
@@ -77,7 +80,10 @@ private:
     juce::PopupMenu::Item saveAsItem;
     juce::PopupMenu::Item goToPresetFolderItem;
     juce::PopupMenu::Item rescanPresetsItem;
+    juce::PopupMenu::Item restoreFactoryPresetsItem;
+    juce::PopupMenu::Item searchPresetsItem;
     bool doNothingOnPresetMenuChangeCallback;
+    static constexpr int MAX_SEARCH_RESULTS = 50;
     //==============================================================================
     /*
     *  It creates something like result of `tree` command on GUI
@@ -89,6 +95,7 @@ private:
                                juce::File currentDir);
 
     void loadPresetMenu();
+    void buildPresetMenu();
     void presetMenuChanged();
     void prevClicked();
     void nextClicked();
@@ -96,6 +103,10 @@ private:
     void saveAsClicked();
     void goToPresetFolderClicked();
     void rescanPresetsClicked();
+    void restoreFactoryPresetsClicked();
+    void searchPresetsClicked();
+    void showSearchResults();
+    void hideSearchBox();
     void selectCurrentPreset();
     int presetArrayIdx (int presetMenuItemId);
     int presetMenuItemId (int presetArrayIdx);
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+   JuceSynthEngineAdapter Test
+
+  ==============================================================================
+*/
+
+#include "../../src/adapters/JuceSynthEngineAdapter.h"
+#include "../dsp/util/AudioBufferMock.h"
+#include "../dsp/util/PositionInfoMock.h"
+#include "../synth/SynthParamsMock.h"
+#include "../synth/SynthVoiceMock.h"
+#include <JuceHeader.h>
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+//==============================================================================
+// JuceSynthEngineAdapter
+
+class JuceSynthEngineAdapterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // Only the first voice is used and logged
+        std::dynamic_pointer_cast<SynthVoiceMock> (voices[0])->setLogsRenderNextBlock (true);
+        synth.setNumberOfVoices (1);
+    }
+
+    void render (const juce::MidiBuffer& midi)
+    {
+        adapter.renderNextBlock (&audioBuffer, midi, 0, samplesPerBlock);
+    }
+
+    static constexpr int samplesPerBlock = 32;
+    SynthParamsMockValues synthParamsMockValues {};
+    std::shared_ptr<SynthParams> synthParams { synthParamsMockValues.getSynthParams() };
+    PositionInfoMock positionInfo {};
+    Lfo lfo { synthParams->lfo(), &positionInfo };
+    std::vector<std::string> logs;
+    std::vector<std::shared_ptr<ISynthVoice>> voices { SynthVoiceMock::buildVoices (SynthEngine::getMaxNumVoices(), logs) };
+    SynthEngine synth { synthParams.get(), &positionInfo, &lfo, voices };
+    JuceSynthEngineAdapter adapter { synth };
+    AudioBufferMock audioBuffer { 2, samplesPerBlock };
+};
+
+TEST_F (JuceSynthEngineAdapterTest, EveryEventIsSampleAccurateByDefault)
+{
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::pitchWheel (1, 100), 3);
+    midi.addEvent (juce::MidiMessage::pitchWheel (1, 200), 5);
+    render (midi);
+    const std::vector<std::string> expected = {
+        "renderNextBlock: 0 0 3",
+        "setPitchWheel: 0 100",
+        "renderNextBlock: 0 3 2",
+        "setPitchWheel: 0 200",
+        "renderNextBlock: 0 5 27",
+    };
+    EXPECT_EQ (logs, expected);
+}
+
+TEST_F (JuceSynthEngineAdapterTest, PitchWheelIsCoalescedWithinGranule)
+{
+    adapter.setControlGranularity (8);
+    juce::MidiBuffer midi;
+    for (int i = 0; i < 8; i++)
+        midi.addEvent (juce::MidiMessage::pitchWheel (1, 100 + i), i);
+    midi.addEvent (juce::MidiMessage::pitchWheel (1, 300), 13);
+    render (midi);
+    const std::vector<std::string> expected = {
+        "setPitchWheel: 0 107",
+        "renderNextBlock: 0 0 8",
+        "setPitchWheel: 0 300",
+        "renderNextBlock: 0 8 24",
+    };
+    EXPECT_EQ (logs, expected);
+}
+
+TEST_F (JuceSynthEngineAdapterTest, CoalescedPitchWheelIsCounted)
+{
+    TelemetryRing ring;
+    synth.getTelemetry().setRing (&ring);
+    adapter.setControlGranularity (8);
+    juce::MidiBuffer midi;
+    for (int i = 0; i < 8; i++)
+        midi.addEvent (juce::MidiMessage::pitchWheel (1, 100 + i), i);
+    midi.addEvent (juce::MidiMessage::pitchWheel (1, 300), 13);
+    render (midi);
+    synth.getTelemetry().setRing (nullptr);
+
+    int numEvents = 0;
+    BlockTelemetry record {};
+    while (ring.pop (record))
+        numEvents += record.numEvents;
+    EXPECT_EQ (numEvents, EngineTelemetry::isEnabled ? 9 : 0);
+}
+
+TEST_F (JuceSynthEngineAdapterTest, NotesStaySampleAccurateWithGranularity)
+{
+    adapter.setControlGranularity (8);
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::pitchWheel (1, 100), 1);
+    midi.addEvent (juce::MidiMessage::noteOn (1, 69, (juce::uint8) 127), 3);
+    // It's in the same granule but it must not be applied before the note
+    midi.addEvent (juce::MidiMessage::pitchWheel (1, 200), 5);
+    midi.addEvent (juce::MidiMessage::noteOff (1, 69), 21);
+    render (midi);
+    const std::vector<std::string> expected = {
+        "setPitchWheel: 0 100",
+        "renderNextBlock: 0 0 3",
+        "startNote: 0 69 1.00 100",
+        "setPitchWheel: 0 200",
+        "renderNextBlock: 0 3 18",
+        "stopNote: 0 1",
+        "renderNextBlock: 0 21 11",
+    };
+    EXPECT_EQ (logs, expected);
+}
+} // namespace onsen
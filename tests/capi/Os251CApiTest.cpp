@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+   OS-251 C API Test
+
+  ==============================================================================
+*/
+
+#include "../../src/capi/os251.h"
+#include "../../src/services/PresetBinaryFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace onsen
+{
+//==============================================================================
+// C API
+
+class Os251CApiTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        engine = os251_create (sampleRate, maxBlockSize);
+        ASSERT_NE (engine, nullptr);
+    }
+
+    void TearDown() override
+    {
+        os251_destroy (engine);
+    }
+
+    // Returns the peak of the left channel
+    float render (int numSamples)
+    {
+        left.assign (numSamples, 1.0f); // Garbage which must be overwritten
+        right.assign (numSamples, 1.0f);
+        float* outputs[] = { left.data(), right.data() };
+        EXPECT_EQ (os251_render (engine, outputs, 2, numSamples), OS251_OK);
+        float peak = 0.0f;
+        for (auto val : left)
+            peak = std::max (peak, std::abs (val));
+        return peak;
+    }
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int maxBlockSize = 256;
+    os251_engine* engine = nullptr;
+    std::vector<float> left;
+    std::vector<float> right;
+};
+
+TEST_F (Os251CApiTest, CreateWithInvalidArguments)
+{
+    EXPECT_EQ (os251_create (0.0, 256), nullptr);
+    EXPECT_EQ (os251_create (48000.0, 0), nullptr);
+    // It's a no-op like free()
+    os251_destroy (nullptr);
+}
+
+TEST_F (Os251CApiTest, SilentWithoutNotes)
+{
+    EXPECT_FLOAT_EQ (render (1000), 0.0f);
+}
+
+TEST_F (Os251CApiTest, NoteOnAndNoteOff)
+{
+    EXPECT_EQ (os251_note_on (engine, 69, 100), OS251_OK);
+    // Longer than the max block size
+    EXPECT_GT (render (1000), 0.0f);
+    EXPECT_EQ (left, right);
+
+    EXPECT_EQ (os251_note_off (engine, 69), OS251_OK);
+    render (static_cast<int> (sampleRate) * 4); // Release
+    EXPECT_LT (render (100), 1.0e-6f);
+}
+
+TEST_F (Os251CApiTest, RawMidi)
+{
+    const uint8_t noteOn[] = { 0x90, 69, 100 };
+    EXPECT_EQ (os251_midi (engine, noteOn, 3), OS251_OK);
+    EXPECT_GT (render (512), 0.0f);
+    // Ignored
+    const uint8_t programChange[] = { 0xc0, 1 };
+    EXPECT_EQ (os251_midi (engine, programChange, 2), OS251_OK);
+}
+
+TEST_F (Os251CApiTest, SampleAccurateMidi)
+{
+    const os251_midi_event events[] = { { 100, 3, { 0x90, 69, 100 } } };
+    std::vector<float> buffer (256, 1.0f);
+    float* outputs[] = { buffer.data() };
+    ASSERT_EQ (os251_render_midi (engine, outputs, 1, 256, events, 1), OS251_OK);
+    for (int i = 0; i < 100; i++)
+        ASSERT_EQ (buffer[i], 0.0f) << i;
+    EXPECT_TRUE (std::any_of (buffer.begin() + 100, buffer.end(), [] (float val) { return val != 0.0f; }));
+
+    EXPECT_EQ (os251_render_midi (engine, outputs, 1, 256, nullptr, 1), OS251_ERROR_INVALID_ARGUMENT);
+}
+
+TEST_F (Os251CApiTest, SampleAccurateMidiAfterManyEvents)
+{
+    // More events than the C API decodes at once. Note offs without note ons change nothing.
+    std::vector<os251_midi_event> events;
+    for (int i = 0; i < 100; i++)
+        events.push_back ({ i, 3, { 0x80, 60, 0 } });
+    events.push_back ({ 150, 3, { 0x90, 69, 100 } });
+
+    std::vector<float> buffer (256, 1.0f);
+    float* outputs[] = { buffer.data() };
+    ASSERT_EQ (os251_render_midi (engine, outputs, 1, 256, events.data(), static_cast<int> (events.size())), OS251_OK);
+    for (int i = 0; i < 150; i++)
+        ASSERT_EQ (buffer[i], 0.0f) << i;
+    EXPECT_TRUE (std::any_of (buffer.begin() + 150, buffer.end(), [] (float val) { return val != 0.0f; }));
+}
+
+TEST_F (Os251CApiTest, InvalidMidiArguments)
+{
+    EXPECT_EQ (os251_note_on (engine, 128, 100), OS251_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ (os251_note_on (engine, 60, 128), OS251_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ (os251_note_off (engine, -1), OS251_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ (os251_pitch_wheel (engine, 16384), OS251_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ (os251_note_on (nullptr, 60, 100), OS251_ERROR_INVALID_ARGUMENT);
+
+    float buffer[16];
+    float* outputs[] = { buffer, buffer, buffer };
+    EXPECT_EQ (os251_render (engine, outputs, 3, 16), OS251_ERROR_INVALID_ARGUMENT);
+}
+
+TEST_F (Os251CApiTest, Params)
+{
+    const int numParams = os251_get_num_params (engine);
+    ASSERT_GT (numParams, 0);
+    bool hasNumVoices = false;
+    for (int i = 0; i < numParams; i++)
+    {
+        const char* paramId = os251_get_param_id (engine, i);
+        ASSERT_NE (paramId, nullptr);
+        hasNumVoices |= std::strcmp (paramId, "numVoices") == 0;
+    }
+    EXPECT_TRUE (hasNumVoices);
+    EXPECT_EQ (os251_get_param_id (engine, numParams), nullptr);
+
+    float value = -1.0f;
+    EXPECT_EQ (os251_set_param (engine, "masterVolume", 0.25f), OS251_OK);
+    EXPECT_EQ (os251_get_param (engine, "masterVolume", &value), OS251_OK);
+    EXPECT_FLOAT_EQ (value, 0.25f);
+    EXPECT_EQ (os251_set_param (engine, "unknown", 0.25f), OS251_ERROR_UNKNOWN_PARAM);
+
+    os251_reset_params (engine);
+    EXPECT_EQ (os251_get_param (engine, "masterVolume", &value), OS251_OK);
+    EXPECT_NE (value, 0.25f);
+}
+
+TEST_F (Os251CApiTest, LoadPreset)
+{
+    PresetBinaryFormat::PresetRecord record;
+    PresetBinaryFormat::initRecord (record, "1.3.0");
+    PresetBinaryFormat::setParam (record, "masterVolume", 0.0);
+    PresetBinaryFormat::setParam (record, "unisonOn", 1.0);
+    PresetBinaryFormat::setParam (record, "unknown", 1.0);
+    const auto data = PresetBinaryFormat::writeRecord (record);
+
+    EXPECT_EQ (os251_set_param (engine, "attack", 0.75f), OS251_OK);
+    ASSERT_EQ (os251_load_preset (engine, data.data(), data.size()), OS251_OK);
+    float value = -1.0f;
+    os251_get_param (engine, "masterVolume", &value);
+    EXPECT_FLOAT_EQ (value, 0.0f);
+    os251_get_param (engine, "unisonOn", &value);
+    EXPECT_FLOAT_EQ (value, 1.0f);
+    // Not in the preset
+    os251_get_param (engine, "attack", &value);
+    EXPECT_NE (value, 0.75f);
+
+    const char broken[] = "broken";
+    EXPECT_EQ (os251_load_preset (engine, broken, sizeof (broken)), OS251_ERROR_INVALID_PRESET);
+}
+} // namespace onsen
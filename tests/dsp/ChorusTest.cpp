@@ -7,6 +7,7 @@
 */
 
 #include "../../src/dsp/Chorus.h"
+#include "../../src/synth/RealtimeCheck.h"
 #include "util/AudioBufferMock.h"
 #include "util/TestAudioBufferInput.h"
 #include <gtest/gtest.h>
@@ -47,4 +48,156 @@ TEST_F (ChorusTest, Snapshot)
     EXPECT_FLOAT_EQ (audioBuffer.getSample (0, samplesPerBlock - 1), 0.99609375);
 }
 
+TEST_F (ChorusTest, SameOutputForAnyBlockSplit)
+{
+    for (const int numTaps : { 1, 2, 5, Chorus::MAX_NUM_TAPS })
+    {
+        for (const bool interpolates : { true, false })
+        {
+            Chorus whole;
+            Chorus split;
+            for (auto* c : { &whole, &split })
+            {
+                c->setCurrentPlaybackSampleRate (sampleRate);
+                c->setInterpolateBufferAccess (interpolates);
+                c->setNumTaps (numTaps);
+            }
+            AudioBufferMock wholeBuffer { numChannel, samplesPerBlock };
+            AudioBufferMock splitBuffer { numChannel, samplesPerBlock };
+            setTestInput1 (&wholeBuffer);
+            setTestInput1 (&splitBuffer);
+
+            whole.render (&wholeBuffer, 0, samplesPerBlock);
+            int pos = 0;
+            // Runs in the delay line don't depend on the host's blocks
+            for (const int numSamples : { 1, 63, 700, 1000, samplesPerBlock - 1764 })
+            {
+                split.render (&splitBuffer, pos, numSamples);
+                pos += numSamples;
+            }
+            ASSERT_EQ (pos, samplesPerBlock);
+            for (int ch = 0; ch < numChannel; ch++)
+            {
+                for (int i = 0; i < samplesPerBlock; i++)
+                    ASSERT_FLOAT_EQ (splitBuffer.getSample (ch, i), wholeBuffer.getSample (ch, i)) << numTaps << " taps, " << i;
+            }
+        }
+    }
+}
+
+TEST_F (ChorusTest, EnsembleIsStereo)
+{
+    chorus.setNumTaps (4);
+    chorus.render (&audioBuffer, 0, samplesPerBlock);
+
+    // Dry until the shortest delay, then the taps differ between the channels
+    EXPECT_FLOAT_EQ (audioBuffer.getSample (0, 20), 0.078125);
+    EXPECT_FLOAT_EQ (audioBuffer.getSample (1, 20), 0.078125);
+    flnum maxDifference = 0.0;
+    for (int i = 0; i < samplesPerBlock; i++)
+        maxDifference = std::max (maxDifference, std::abs (audioBuffer.getSample (0, i) - audioBuffer.getSample (1, i)));
+    EXPECT_GT (maxDifference, 1e-3);
+}
+
+TEST_F (ChorusTest, EnsembleKeepsLevel)
+{
+    // A constant input settles at input * (1 + 1 / (1 - feedback)) for any number of taps
+    const flnum input = 0.5;
+    const flnum expected = input * (1.0 + 1.0 / (1.0 - 0.3));
+    for (int numTaps = 1; numTaps <= Chorus::MAX_NUM_TAPS; numTaps++)
+    {
+        Chorus ensemble;
+        ensemble.setCurrentPlaybackSampleRate (sampleRate);
+        ensemble.setNumTaps (numTaps);
+        AudioBufferMock constant { numChannel, samplesPerBlock };
+        for (int block = 0; block < 8; block++)
+        {
+            for (int ch = 0; ch < numChannel; ch++)
+                std::fill_n (constant.getWritePointer (ch), samplesPerBlock, input);
+            ensemble.render (&constant, 0, samplesPerBlock);
+        }
+        for (int ch = 0; ch < numChannel; ch++)
+            EXPECT_NEAR (constant.getSample (ch, samplesPerBlock - 1), expected, 1e-4) << numTaps << " taps";
+    }
+}
+
+TEST_F (ChorusTest, SwitchSampleRate)
+{
+    chorus.render (&audioBuffer, 0, samplesPerBlock);
+    {
+        // Like an offline bounce at a higher rate. RealtimeGuard.cpp fails the test if it allocates.
+        RealtimeCheck::AudioCallbackScope audioCallback ("Chorus::setCurrentPlaybackSampleRate");
+        chorus.setCurrentPlaybackSampleRate (MAX_SAMPLE_RATE);
+        chorus.setCurrentPlaybackSampleRate (96000.0);
+        chorus.setCurrentPlaybackSampleRate (sampleRate);
+    }
+
+    // The delay line was cleared, so the beginning is dry as in the snapshot
+    setTestInput1 (&audioBuffer);
+    chorus.render (&audioBuffer, 0, samplesPerBlock - 1);
+    EXPECT_FLOAT_EQ (audioBuffer.getSample (0, 20), 0.078125);
+    EXPECT_FLOAT_EQ (audioBuffer.getSample (0, 77), 0.30078125);
+}
+
+TEST_F (ChorusTest, RenderTailOfSilentInput)
+{
+    // Silent input right after construction is skipped
+    AudioBufferMock silence { numChannel, samplesPerBlock };
+    EXPECT_TRUE (chorus.renderSilentInput (&silence, 0, samplesPerBlock));
+
+    chorus.render (&audioBuffer, 0, samplesPerBlock);
+    const int tailSamples = static_cast<int> (std::ceil (chorus.getTailLengthSeconds() * sampleRate));
+    ASSERT_GT (tailSamples, 0);
+    int renderedSamples = 0;
+    flnum peak = 0.0;
+    while (true)
+    {
+        AudioBufferMock tail { numChannel, samplesPerBlock };
+        if (chorus.renderSilentInput (&tail, 0, samplesPerBlock))
+        {
+            // Nothing is rendered and the delay line is cleared
+            EXPECT_FLOAT_EQ (tail.getSample (0, 0), 0.0);
+            break;
+        }
+        renderedSamples += samplesPerBlock;
+        ASSERT_LE (renderedSamples, tailSamples + samplesPerBlock);
+        peak = std::max (peak, std::abs (tail.getSample (0, samplesPerBlock - 1)));
+    }
+    EXPECT_GE (renderedSamples, tailSamples);
+    // The feedback rang at first
+    EXPECT_GT (peak, 0.0);
+
+    // The decayed delay line has nothing left for the next input
+    setTestInput1 (&audioBuffer);
+    const flnum firstSample = audioBuffer.getSample (0, 0);
+    chorus.render (&audioBuffer, 0, 1);
+    EXPECT_FLOAT_EQ (audioBuffer.getSample (0, 0), firstSample);
+}
+
+TEST_F (ChorusTest, TailIncludesFirstPass)
+{
+    // 15 ms delay modulated by 10 %
+    const double roundTripSeconds = 0.015 * 1.1;
+    chorus.setFeedback (0.5);
+    // 0.5^17 < SILENCE_THRESHOLD <= 0.5^16, so the last audible echo is the 17th after the first pass
+    EXPECT_NEAR (chorus.getTailLengthSeconds(), 18 * roundTripSeconds, 1.0e-6);
+
+    // Only the first pass
+    chorus.setFeedback (0.0);
+    EXPECT_NEAR (chorus.getTailLengthSeconds(), roundTripSeconds, 1.0e-6);
+}
+
+TEST_F (ChorusTest, EndlessFeedback)
+{
+    chorus.setFeedback (1.0);
+    EXPECT_TRUE (std::isinf (chorus.getTailLengthSeconds()));
+
+    chorus.render (&audioBuffer, 0, samplesPerBlock);
+    for (int i = 0; i < 100; i++)
+    {
+        AudioBufferMock tail { numChannel, samplesPerBlock };
+        ASSERT_FALSE (chorus.renderSilentInput (&tail, 0, samplesPerBlock));
+    }
+}
+
 } // namespace onsen
@@ -28,6 +28,18 @@ protected:
     HpfParamsMock hpfParam;
 };
 
+// Frequency which a test can change
+class HpfParamsForTest : public IHpfParams
+{
+public:
+    flnum getFrequency() const override
+    {
+        return frequency;
+    }
+
+    flnum frequency = 20.0;
+};
+
 TEST_F (HpfTest, SnapshotFor1Ch)
 {
     const int numChannels = 1;
@@ -43,6 +55,29 @@ TEST_F (HpfTest, SnapshotFor1Ch)
     EXPECT_FLOAT_EQ (audioBuffer.getSample (0, samplesPerBlock - 1), 0.2468688);
 }
 
+TEST_F (HpfTest, IdleAfterDecay)
+{
+    const int numChannels = 2;
+    Hpf hpf { &hpfParam, numChannels };
+    hpf.setCurrentPlaybackSampleRate (sampleRate);
+    EXPECT_TRUE (hpf.isIdle());
+
+    AudioBufferMock audioBuffer { numChannels, samplesPerBlock };
+    setTestInput1 (&audioBuffer);
+    hpf.render (&audioBuffer, 0, samplesPerBlock);
+    EXPECT_FALSE (hpf.isIdle());
+
+    // Silent input lets the state decay
+    for (int i = 0; i < 100 && ! hpf.isIdle(); i++)
+    {
+        AudioBufferMock silence { numChannels, samplesPerBlock };
+        hpf.render (&silence, 0, samplesPerBlock);
+    }
+    EXPECT_TRUE (hpf.isIdle());
+    hpf.skip (samplesPerBlock);
+    EXPECT_TRUE (hpf.isIdle());
+}
+
 TEST_F (HpfTest, SnapshotFor2Ch)
 {
     const int numChannels = 2;
@@ -60,4 +95,98 @@ TEST_F (HpfTest, SnapshotFor2Ch)
     EXPECT_FLOAT_EQ (audioBuffer.getSample (1, 20), 0.18569922);
     EXPECT_FLOAT_EQ (audioBuffer.getSample (1, samplesPerBlock - 1), 0.2468688);
 }
+
+TEST_F (HpfTest, ChannelsAreIndependent)
+{
+    // A pair of lanes and a single lane
+    const int numChannels = 3;
+    Hpf hpf { &hpfParam, numChannels };
+    hpf.setCurrentPlaybackSampleRate (sampleRate);
+    AudioBufferMock audioBuffer { numChannels, samplesPerBlock };
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        for (int i = 0; i < samplesPerBlock; i++)
+            audioBuffer.getWritePointer (ch)[i] = std::sin (0.01 * (ch + 1) * i);
+    }
+    hpf.render (&audioBuffer, 0, samplesPerBlock);
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        Hpf mono { &hpfParam, 1 };
+        mono.setCurrentPlaybackSampleRate (sampleRate);
+        AudioBufferMock monoBuffer { 1, samplesPerBlock };
+        for (int i = 0; i < samplesPerBlock; i++)
+            monoBuffer.getWritePointer (0)[i] = std::sin (0.01 * (ch + 1) * i);
+        mono.render (&monoBuffer, 0, samplesPerBlock);
+        for (int i = 0; i < samplesPerBlock; i++)
+            ASSERT_FLOAT_EQ (audioBuffer.getSample (ch, i), monoBuffer.getSample (0, i)) << ch << ", " << i;
+    }
+}
+
+TEST_F (HpfTest, RampCoefficientsAcrossBlock)
+{
+    const int numChannels = 2;
+    HpfParamsForTest heldParams;
+    HpfParamsForTest movedParams;
+    Hpf held { &heldParams, numChannels };
+    Hpf moved { &movedParams, numChannels };
+    AudioBufferMock heldBuffer { numChannels, samplesPerBlock };
+    AudioBufferMock movedBuffer { numChannels, samplesPerBlock };
+
+    // 1 kHz passes through the filter at 20 Hz
+    const auto renderSine = [&] (int block) {
+        for (auto* buffer : { &heldBuffer, &movedBuffer })
+        {
+            for (int ch = 0; ch < numChannels; ch++)
+            {
+                for (int i = 0; i < samplesPerBlock; i++)
+                    buffer->getWritePointer (ch)[i] = std::sin (2.0 * 3.141592653589793 * 1000.0 * (block * samplesPerBlock + i) / sampleRate);
+            }
+        }
+        held.render (&heldBuffer, 0, samplesPerBlock);
+        moved.render (&movedBuffer, 0, samplesPerBlock);
+    };
+    for (auto* hpf : { &held, &moved })
+        hpf->setCurrentPlaybackSampleRate (sampleRate);
+    for (int block = 0; block < 8; block++)
+        renderSine (block);
+
+    // The coefficients start where the previous block ended, so the output doesn't jump
+    movedParams.frequency = 20000.0;
+    renderSine (8);
+    for (int ch = 0; ch < numChannels; ch++)
+        EXPECT_NEAR (movedBuffer.getSample (ch, 0), heldBuffer.getSample (ch, 0), 0.01);
+    // and get close to the new frequency by the end of the block
+    flnum peak = 0.0;
+    for (int i = samplesPerBlock - 64; i < samplesPerBlock; i++)
+        peak = std::max (peak, std::abs (movedBuffer.getSample (0, i)));
+    EXPECT_LT (peak, 0.5);
+}
+
+TEST_F (HpfTest, ResetSnapsToFrequency)
+{
+    const int numChannels = 2;
+    HpfParamsForTest params;
+    Hpf moved { &params, numChannels };
+    moved.setCurrentPlaybackSampleRate (sampleRate);
+    AudioBufferMock movedBuffer { numChannels, samplesPerBlock };
+    setTestInput1 (&movedBuffer);
+    moved.render (&movedBuffer, 0, samplesPerBlock);
+
+    // After reset(), the output is the same as a new filter's, without a glide from 20 Hz
+    params.frequency = 2000.0;
+    moved.reset();
+    Hpf fresh { &params, numChannels };
+    fresh.setCurrentPlaybackSampleRate (sampleRate);
+    AudioBufferMock freshBuffer { numChannels, samplesPerBlock };
+    setTestInput1 (&movedBuffer);
+    setTestInput1 (&freshBuffer);
+    moved.render (&movedBuffer, 0, samplesPerBlock);
+    fresh.render (&freshBuffer, 0, samplesPerBlock);
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        for (int i = 0; i < samplesPerBlock; i++)
+            ASSERT_FLOAT_EQ (movedBuffer.getSample (ch, i), freshBuffer.getSample (ch, i)) << ch << ", " << i;
+    }
+}
 } // namespace onsen
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+   Quadrature Oscillator Test
+
+  ==============================================================================
+*/
+
+#include "../../src/dsp/QuadratureOscillator.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+//==============================================================================
+// Quadrature oscillator
+
+TEST (QuadratureOscillatorTest, FollowSinAndCos)
+{
+    QuadratureOscillator osc;
+    const double sampleRate = 48000.0;
+    const double freq = 0.5;
+    osc.setFrequency (freq, sampleRate);
+    osc.setPhase (0.3);
+
+    // 10 minutes
+    const int numSamples = static_cast<int> (sampleRate * 600);
+    for (int i = 0; i < numSamples; i++)
+    {
+        if (i % 4801 == 0)
+        {
+            // pi is flnum, which is too coarse after minutes
+            const double angle = 0.3 + 2.0 * 3.141592653589793 * freq * i / sampleRate;
+            ASSERT_NEAR (osc.getSin(), std::sin (angle), 1.0e-6) << i;
+            ASSERT_NEAR (osc.getCos(), std::cos (angle), 1.0e-6) << i;
+            ASSERT_NEAR (std::sin (osc.getPhase()), std::sin (angle), 1.0e-6) << i;
+        }
+        osc.advance();
+    }
+    // The amplitude doesn't drift
+    EXPECT_NEAR (osc.getSin() * osc.getSin() + osc.getCos() * osc.getCos(), 1.0, 1.0e-6);
+}
+
+TEST (QuadratureOscillatorTest, ChangeFrequencyWithoutJump)
+{
+    QuadratureOscillator osc;
+    osc.setFrequency (1.0, 1000.0);
+    for (int i = 0; i < 250; i++)
+        osc.advance();
+    EXPECT_NEAR (osc.getSin(), 1.0, 1.0e-6);
+
+    // Continues from the current phase
+    osc.setFrequency (2.0, 1000.0);
+    EXPECT_NEAR (osc.getSin(), 1.0, 1.0e-6);
+    for (int i = 0; i < 125; i++)
+        osc.advance();
+    EXPECT_NEAR (osc.getSin(), 0.0, 1.0e-6);
+    EXPECT_NEAR (osc.getCos(), -1.0, 1.0e-6);
+    EXPECT_NEAR (osc.getPhase(), pi, 1.0e-6);
+}
+
+TEST (QuadratureOscillatorTest, SetPhase)
+{
+    QuadratureOscillator osc;
+    osc.setPhase (-pi / 2.0);
+    EXPECT_NEAR (osc.getSin(), -1.0, 1.0e-6);
+    EXPECT_NEAR (osc.getPhase(), 1.5 * pi, 1.0e-6);
+    osc.setPhase (5.0 * pi);
+    EXPECT_NEAR (osc.getCos(), -1.0, 1.0e-6);
+    EXPECT_NEAR (osc.getPhase(), pi, 1.0e-5);
+}
+} // namespace onsen
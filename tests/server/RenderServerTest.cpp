@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+   Render Server Test
+
+  ==============================================================================
+*/
+
+#include "../../src/server/RenderServer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+namespace onsen
+{
+//==============================================================================
+// Render server
+
+class RenderServerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        PresetBinaryFormat::PackItem silent;
+        silent.path = "Test/Silent";
+        PresetBinaryFormat::initRecord (silent.record, "1.3.0");
+        PresetBinaryFormat::setParam (silent.record, "masterVolume", 0.0);
+
+        RenderServer::Config config;
+        config.sampleRate = 48000.0;
+        config.maxSamplesPerBlock = 256;
+        config.numWorkers = 2;
+        config.maxBatchSize = 4;
+        server = std::make_unique<RenderServer> (config, std::vector<PresetBinaryFormat::PackItem> { silent });
+
+        ASSERT_EQ (::socketpair (AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        serverThread = std::thread ([this] { server->serve (fds[1], fds[1]); });
+    }
+
+    void TearDown() override
+    {
+        ::shutdown (fds[0], SHUT_WR);
+        serverThread.join();
+        ::close (fds[0]);
+        ::close (fds[1]);
+    }
+
+    // A note which starts at the beginning
+    void sendRequest (std::uint32_t requestId, const std::string& presetPath, std::uint32_t numSamples, const std::string& shmName = "")
+    {
+        RenderProtocol::RequestHeader header {};
+        std::memcpy (header.magic, RenderProtocol::REQUEST_MAGIC, sizeof (header.magic));
+        header.requestId = requestId;
+        header.numSamples = numSamples;
+        header.numChannels = 2;
+        header.numEvents = 2;
+        std::strncpy (header.presetPath, presetPath.c_str(), sizeof (header.presetPath) - 1);
+        std::strncpy (header.shmName, shmName.c_str(), sizeof (header.shmName) - 1);
+        const RenderProtocol::Event events[] = {
+            { numSamples / 2, { 0x80, 60, 0 }, 3 },
+            { 0, { 0x90, 60, 100 }, 3 },
+        };
+        ASSERT_TRUE (RenderProtocol::writeAll (fds[0], &header, sizeof (header)));
+        ASSERT_TRUE (RenderProtocol::writeAll (fds[0], events, sizeof (events)));
+    }
+
+    // Returns the peak of the audio in the stream
+    float receiveResponse (RenderProtocol::ResponseHeader& response, bool hasAudio = true)
+    {
+        EXPECT_TRUE (RenderProtocol::readAll (fds[0], &response, sizeof (response)));
+        EXPECT_EQ (std::memcmp (response.magic, RenderProtocol::RESPONSE_MAGIC, sizeof (response.magic)), 0);
+        if (! hasAudio)
+            return 0.0f;
+        std::vector<float> audio (static_cast<size_t> (response.numChannels) * response.numSamples);
+        EXPECT_TRUE (RenderProtocol::readAll (fds[0], audio.data(), audio.size() * sizeof (float)));
+        return peak (audio.data(), audio.size());
+    }
+
+    static float peak (const float* audio, size_t size)
+    {
+        float val = 0.0f;
+        for (size_t i = 0; i < size; i++)
+            val = std::max (val, std::abs (audio[i]));
+        return val;
+    }
+
+    std::unique_ptr<RenderServer> server;
+    int fds[2] = { -1, -1 };
+    std::thread serverThread;
+};
+
+TEST_F (RenderServerTest, RenderInStream)
+{
+    sendRequest (1, "", 4800);
+    RenderProtocol::ResponseHeader response;
+    const auto audioPeak = receiveResponse (response);
+    EXPECT_EQ (response.requestId, 1u);
+    EXPECT_EQ (response.status, RenderProtocol::ok);
+    EXPECT_EQ (response.numSamples, 4800u);
+    EXPECT_EQ (response.numChannels, 2u);
+    EXPECT_EQ (response.sampleRate, 48000u);
+    EXPECT_GT (audioPeak, 0.0f);
+}
+
+TEST_F (RenderServerTest, RenderIntoSharedMemory)
+{
+    const std::string shmName = "/os251-render-server-test-" + std::to_string (::getpid());
+    constexpr std::uint32_t numSamples = 4800;
+    constexpr size_t size = 2 * numSamples * sizeof (float);
+    const int shmFd = ::shm_open (shmName.c_str(), O_CREAT | O_RDWR, 0600);
+    ASSERT_GE (shmFd, 0);
+    ASSERT_EQ (::ftruncate (shmFd, size), 0);
+    void* mapped = ::mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+    ASSERT_NE (mapped, MAP_FAILED);
+
+    sendRequest (2, "", numSamples, shmName);
+    RenderProtocol::ResponseHeader response;
+    receiveResponse (response, false);
+    EXPECT_EQ (response.status, RenderProtocol::ok);
+    EXPECT_GT (peak (static_cast<float*> (mapped), 2 * numSamples), 0.0f);
+
+    // Too small
+    ASSERT_EQ (::ftruncate (shmFd, size / 2), 0);
+    sendRequest (3, "", numSamples, shmName);
+    receiveResponse (response, false);
+    EXPECT_EQ (response.status, RenderProtocol::sharedMemoryError);
+
+    ::munmap (mapped, size);
+    ::close (shmFd);
+    ::shm_unlink (shmName.c_str());
+}
+
+TEST_F (RenderServerTest, ErrorsDoNotBreakStream)
+{
+    RenderProtocol::ResponseHeader response;
+    sendRequest (4, "Unknown", 480);
+    receiveResponse (response);
+    EXPECT_EQ (response.requestId, 4u);
+    EXPECT_EQ (response.status, RenderProtocol::unknownPreset);
+    EXPECT_EQ (response.numSamples, 0u);
+
+    sendRequest (5, "", RenderProtocol::MAX_NUM_SAMPLES + 1);
+    receiveResponse (response);
+    EXPECT_EQ (response.status, RenderProtocol::badRequest);
+
+    sendRequest (6, "", 480);
+    receiveResponse (response);
+    EXPECT_EQ (response.status, RenderProtocol::ok);
+}
+
+TEST_F (RenderServerTest, RejectBadShmNames)
+{
+    RenderProtocol::ResponseHeader response;
+    std::uint32_t requestId = 10;
+    // Only a name directly under the shm namespace may be opened
+    for (const auto* name : { "os251-no-slash", "/", "/os251/nested", "/.." })
+    {
+        sendRequest (requestId, "", 480, name);
+        receiveResponse (response, false);
+        EXPECT_EQ (response.requestId, requestId) << name;
+        EXPECT_EQ (response.status, RenderProtocol::badRequest) << name;
+        requestId++;
+    }
+}
+
+TEST_F (RenderServerTest, BatchRequests)
+{
+    // Presets alternate, so batches are reordered by preset
+    constexpr std::uint32_t numRequests = 16;
+    for (std::uint32_t i = 0; i < numRequests; i++)
+        sendRequest (i, i % 2 ? "Test/Silent" : "", 960);
+
+    std::set<std::uint32_t> requestIds;
+    for (std::uint32_t i = 0; i < numRequests; i++)
+    {
+        RenderProtocol::ResponseHeader response;
+        const auto audioPeak = receiveResponse (response);
+        EXPECT_EQ (response.status, RenderProtocol::ok);
+        // Each request gets its own preset, and notes from previous requests don't sound
+        if (response.requestId % 2)
+            EXPECT_EQ (audioPeak, 0.0f);
+        else
+            EXPECT_GT (audioPeak, 0.0f);
+        requestIds.insert (response.requestId);
+    }
+    EXPECT_EQ (requestIds.size(), numRequests);
+}
+} // namespace onsen
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+   Preset Binary Format Test
+  ==============================================================================
+*/
+
+#include "../../src/services/PresetBinaryFormat.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace onsen
+{
+using namespace PresetBinaryFormat;
+//==============================================================================
+class PresetBinaryFormatTest : public ::testing::Test
+{
+protected:
+    static PresetRecord makeRecord (double attack, double decay)
+    {
+        PresetRecord record;
+        initRecord (record, "1.3.0");
+        setParam (record, "attack", attack);
+        setParam (record, "decay", decay);
+        return record;
+    }
+
+    static std::vector<std::uint8_t> makePack()
+    {
+        std::vector<PackItem> items;
+        items.push_back ({ "User/B.oapreset", makeRecord (0.2, 0.3) });
+        items.push_back ({ "Default.oapreset", makeRecord (0.0, 1.0) });
+        items.push_back ({ "Factory/Bass/A.oapreset", makeRecord (0.4, 0.5) });
+        return writePack (std::move (items));
+    }
+};
+//==============================================================================
+
+TEST_F (PresetBinaryFormatTest, SetAndFindParam)
+{
+    auto record = makeRecord (0.1, 0.2);
+    EXPECT_EQ (record.header.numParams, 2);
+    ASSERT_NE (findParam (record, "attack"), nullptr);
+    EXPECT_EQ (findParam (record, "attack")->value, 0.1);
+    EXPECT_EQ (findParam (record, "sustain"), nullptr);
+
+    // Overwrite
+    EXPECT_TRUE (setParam (record, "attack", 0.3));
+    EXPECT_EQ (record.header.numParams, 2);
+    EXPECT_EQ (findParam (record, "attack")->value, 0.3);
+
+    // Too long
+    EXPECT_FALSE (setParam (record, std::string (MAX_PARAM_ID_LENGTH + 1, 'a'), 0.0));
+    EXPECT_FALSE (setParam (record, "", 0.0));
+}
+
+TEST_F (PresetBinaryFormatTest, RecordIsFull)
+{
+    PresetRecord record;
+    initRecord (record, "1.3.0");
+    for (int i = 0; i < MAX_NUM_PARAMS; i++)
+        EXPECT_TRUE (setParam (record, "param" + std::to_string (i), 0.0));
+    EXPECT_FALSE (setParam (record, "oneMore", 0.0));
+    EXPECT_EQ (record.size(), MAX_RECORD_SIZE);
+}
+
+TEST_F (PresetBinaryFormatTest, WriteAndReadRecord)
+{
+    const auto record = makeRecord (0.1, 0.2);
+    const auto data = writeRecord (record);
+    EXPECT_EQ (data.size(), sizeof (Header) + 2 * sizeof (ParamEntry));
+
+    PresetRecord readBack;
+    ASSERT_TRUE (readRecord (data.data(), data.size(), readBack));
+    EXPECT_STREQ (readBack.header.savedByVersion, "1.3.0");
+    EXPECT_EQ (readBack.header.numParams, 2);
+    EXPECT_STREQ (readBack.params[0].id, "attack");
+    EXPECT_EQ (readBack.params[0].value, 0.1);
+    EXPECT_STREQ (readBack.params[1].id, "decay");
+    EXPECT_EQ (readBack.params[1].value, 0.2);
+}
+
+TEST_F (PresetBinaryFormatTest, BrokenRecordIsRejected)
+{
+    auto data = writeRecord (makeRecord (0.1, 0.2));
+    PresetRecord readBack;
+
+    // Truncated
+    EXPECT_FALSE (readRecord (data.data(), data.size() - 1, readBack));
+    EXPECT_FALSE (readRecord (data.data(), sizeof (Header) - 1, readBack));
+    EXPECT_FALSE (readRecord (nullptr, 0, readBack));
+
+    // Wrong magic
+    auto wrongMagic = data;
+    wrongMagic[0] = 'X';
+    EXPECT_FALSE (readRecord (wrongMagic.data(), wrongMagic.size(), readBack));
+
+    // Too many params
+    auto tooManyParams = data;
+    Header header;
+    std::memcpy (&header, tooManyParams.data(), sizeof (Header));
+    header.numParams = MAX_NUM_PARAMS + 1;
+    std::memcpy (tooManyParams.data(), &header, sizeof (Header));
+    tooManyParams.resize (MAX_RECORD_SIZE + sizeof (ParamEntry));
+    EXPECT_FALSE (readRecord (tooManyParams.data(), tooManyParams.size(), readBack));
+}
+
+TEST_F (PresetBinaryFormatTest, WriteAndReadPack)
+{
+    const auto pack = makePack();
+    ASSERT_TRUE (isValidPack (pack.data(), pack.size()));
+    ASSERT_EQ (getNumPresets (pack.data()), 3u);
+
+    // Sorted by path
+    EXPECT_STREQ (getEntry (pack.data(), 0)->path, "Default.oapreset");
+    EXPECT_STREQ (getEntry (pack.data(), 1)->path, "Factory/Bass/A.oapreset");
+    EXPECT_STREQ (getEntry (pack.data(), 2)->path, "User/B.oapreset");
+    EXPECT_EQ (getEntry (pack.data(), 3), nullptr);
+
+    for (std::uint32_t i = 0; i < 3; i++)
+        EXPECT_EQ (getEntry (pack.data(), i)->offset % 8, 0u);
+
+    const int idx = findPreset (pack.data(), "User/B.oapreset");
+    ASSERT_EQ (idx, 2);
+    EXPECT_EQ (findPreset (pack.data(), "User/C.oapreset"), -1);
+
+    PresetRecord record;
+    ASSERT_TRUE (readPreset (pack.data(), pack.size(), static_cast<std::uint32_t> (idx), record));
+    EXPECT_EQ (findParam (record, "attack")->value, 0.2);
+    EXPECT_EQ (findParam (record, "decay")->value, 0.3);
+    EXPECT_FALSE (readPreset (pack.data(), pack.size(), 3, record));
+}
+
+TEST_F (PresetBinaryFormatTest, EmptyPack)
+{
+    const auto pack = writePack ({});
+    ASSERT_TRUE (isValidPack (pack.data(), pack.size()));
+    EXPECT_EQ (getNumPresets (pack.data()), 0u);
+    EXPECT_EQ (findPreset (pack.data(), "Default.oapreset"), -1);
+}
+
+TEST_F (PresetBinaryFormatTest, BrokenPackIsRejected)
+{
+    auto pack = makePack();
+
+    // Truncated entry table
+    EXPECT_FALSE (isValidPack (pack.data(), sizeof (PackHeader) + sizeof (PackEntry)));
+
+    // Truncated record
+    const auto truncatedSize = static_cast<std::size_t> (getEntry (pack.data(), 2)->offset) + 1;
+    ASSERT_TRUE (isValidPack (pack.data(), truncatedSize));
+    PresetRecord record;
+    EXPECT_TRUE (readPreset (pack.data(), truncatedSize, 1, record));
+    EXPECT_FALSE (readPreset (pack.data(), truncatedSize, 2, record));
+
+    // Path without a terminator
+    auto unterminated = pack;
+    auto* entry = reinterpret_cast<PackEntry*> (unterminated.data() + sizeof (PackHeader)) + 1;
+    std::memset (entry->path, 'a', sizeof (entry->path));
+    EXPECT_FALSE (isValidPack (unterminated.data(), unterminated.size()));
+
+    // Wrong magic
+    pack[0] = 'X';
+    EXPECT_FALSE (isValidPack (pack.data(), pack.size()));
+}
+
+TEST_F (PresetBinaryFormatTest, TooLongPathIsRejected)
+{
+    std::vector<PackItem> items;
+    items.push_back ({ std::string (MAX_PATH_LENGTH + 1, 'a'), makeRecord (0.0, 0.0) });
+    EXPECT_TRUE (writePack (std::move (items)).empty());
+}
+
+} // namespace onsen
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+   Preset Directory Watcher Test
+  ==============================================================================
+*/
+
+#include "../../src/services/PresetDirectoryWatcher.h"
+#include "../../src/services/TmpFileManager.h"
+#include <JuceHeader.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace onsen
+{
+using ChangeType = PresetDirectoryWatcher::Change::Type;
+//==============================================================================
+class PresetDirectoryWatcherTest : public ::testing::TestWithParam<PresetDirectoryWatcher::Mode>
+{
+protected:
+    void SetUp() override
+    {
+        testDir.deleteRecursively();
+        testDir.getChildFile ("User").createDirectory();
+        existingFile.replaceWithText ("Existing");
+        watcher = std::make_unique<PresetDirectoryWatcher> (testDir, GetParam());
+        watcher->start();
+        ASSERT_TRUE (watcher->waitUntilReady (5000));
+    }
+
+    void TearDown() override
+    {
+        watcher.reset();
+        testDir.deleteRecursively();
+    }
+
+    // Collects changes until `numChanges` changes are reported or it times out
+    std::vector<PresetDirectoryWatcher::Change> waitForChanges (size_t numChanges)
+    {
+        std::vector<PresetDirectoryWatcher::Change> changes;
+        const auto deadline = juce::Time::getMillisecondCounter() + 5000;
+        while (changes.size() < numChanges)
+        {
+            const auto now = juce::Time::getMillisecondCounter();
+            if (now >= deadline || ! watcher->waitUntilChanged (static_cast<int> (deadline - now)))
+                break;
+            for (auto& change : watcher->takeChanges())
+                changes.push_back (change);
+        }
+        return changes;
+    }
+
+    static bool contains (const std::vector<PresetDirectoryWatcher::Change>& changes, ChangeType type, const juce::File& file)
+    {
+        for (const auto& change : changes)
+        {
+            if (change.type == type && change.file == file)
+                return true;
+        }
+        return false;
+    }
+
+    const juce::File testDir { onsen::TmpFileManager::getTmpDir().getChildFile ("preset_watcher_test") };
+    const juce::File existingFile { testDir.getChildFile ("User/Existing.oapreset") };
+    std::unique_ptr<PresetDirectoryWatcher> watcher;
+};
+//==============================================================================
+
+TEST_P (PresetDirectoryWatcherTest, ExistingFilesAreNotReported)
+{
+    ASSERT_TRUE (watcher->waitUntilChecked (5000));
+    EXPECT_TRUE (watcher->takeChanges().empty());
+}
+
+TEST_P (PresetDirectoryWatcherTest, AddedFile)
+{
+    auto file = testDir.getChildFile ("User/New.oapreset");
+    file.replaceWithText ("New");
+    auto changes = waitForChanges (1);
+    ASSERT_EQ (changes.size(), 1u);
+    EXPECT_TRUE (contains (changes, ChangeType::added, file));
+}
+
+TEST_P (PresetDirectoryWatcherTest, RemovedFile)
+{
+    existingFile.deleteFile();
+    auto changes = waitForChanges (1);
+    ASSERT_EQ (changes.size(), 1u);
+    EXPECT_TRUE (contains (changes, ChangeType::removed, existingFile));
+}
+
+TEST_P (PresetDirectoryWatcherTest, ModifiedFile)
+{
+    existingFile.replaceWithText ("Modified, and the size has changed");
+    auto changes = waitForChanges (1);
+    ASSERT_GE (changes.size(), 1u);
+    // Replacing a file might be reported as removed and added by some tools
+    EXPECT_TRUE (contains (changes, ChangeType::modified, existingFile)
+                 || contains (changes, ChangeType::added, existingFile));
+}
+
+TEST_P (PresetDirectoryWatcherTest, FilesInNewFolder)
+{
+    auto file = testDir.getChildFile ("User/NewFolder/Sub/New.oapreset");
+    file.create();
+    file.replaceWithText ("New");
+    auto changes = waitForChanges (1);
+    EXPECT_TRUE (contains (changes, ChangeType::added, file));
+
+    // Files in a removed folder are reported as removed
+    testDir.getChildFile ("User/NewFolder").deleteRecursively();
+    changes = waitForChanges (1);
+    EXPECT_TRUE (contains (changes, ChangeType::removed, file));
+}
+
+TEST_P (PresetDirectoryWatcherTest, IgnoreOtherFiles)
+{
+    testDir.getChildFile ("User/NotPreset.txt").replaceWithText ("Text");
+    auto file = testDir.getChildFile ("User/New.oapreset");
+    file.replaceWithText ("New");
+    auto changes = waitForChanges (1);
+    // The text file was written first, so it has been checked by now. Check once more anyway.
+    ASSERT_TRUE (watcher->waitUntilChecked (5000));
+    for (auto& change : watcher->takeChanges())
+        changes.push_back (change);
+    ASSERT_EQ (changes.size(), 1u);
+    EXPECT_TRUE (contains (changes, ChangeType::added, file));
+}
+
+INSTANTIATE_TEST_SUITE_P (Modes,
+                          PresetDirectoryWatcherTest,
+                          ::testing::Values (PresetDirectoryWatcher::Mode::automatic,
+                                             PresetDirectoryWatcher::Mode::polling));
+
+} // namespace onsen
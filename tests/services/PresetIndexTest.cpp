@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+   Preset Index Test
+  ==============================================================================
+*/
+
+#include "../../src/services/PresetIndex.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace onsen
+{
+//==============================================================================
+class PresetIndexTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        presetIndex.add ("Default", ""); // 0
+        presetIndex.add ("Bass0", "Factory/Bass"); // 1
+        presetIndex.add ("Bass1", "Factory/Bass"); // 2
+        presetIndex.add ("FX0", "Factory/FX"); // 3
+        presetIndex.add ("Soft Pad", "Factory/Pad"); // 4
+        presetIndex.add ("Deep Sub", "User/Bass"); // 5
+        presetIndex.add ("Bright Keys", "User/My Keys"); // 6
+        presetIndex.add ("Subtle Bass", "User"); // 7
+    }
+
+    std::vector<int> search (const std::string& query, int maxResults = 100)
+    {
+        std::vector<int> ids;
+        for (const auto& result : presetIndex.search (query, maxResults))
+            ids.push_back (result.id);
+        return ids;
+    }
+
+    PresetIndex presetIndex;
+};
+//==============================================================================
+
+TEST_F (PresetIndexTest, EmptyQuery)
+{
+    EXPECT_TRUE (search ("").empty());
+    EXPECT_TRUE (search (" / ").empty());
+}
+
+TEST_F (PresetIndexTest, NotFound)
+{
+    EXPECT_TRUE (search ("lead").empty());
+    EXPECT_TRUE (search ("xyz").empty());
+}
+
+TEST_F (PresetIndexTest, CaseInsensitive)
+{
+    EXPECT_EQ (search ("soft"), search ("SOFT"));
+    EXPECT_EQ (search ("soft"), std::vector<int> ({ 4 }));
+}
+
+TEST_F (PresetIndexTest, RankedByWhereTermMatches)
+{
+    // Name prefix > word in name > substring of name > folder
+    EXPECT_EQ (search ("bass"), std::vector<int> ({ 1, 2, 7, 5 }));
+    EXPECT_EQ (search ("sub"), std::vector<int> ({ 7, 5 }));
+    EXPECT_EQ (search ("keys"), std::vector<int> ({ 6 }));
+    EXPECT_EQ (search ("ass"), std::vector<int> ({ 1, 2, 7, 5 }));
+}
+
+TEST_F (PresetIndexTest, MatchesFolder)
+{
+    EXPECT_EQ (search ("factory"), std::vector<int> ({ 1, 2, 3, 4 }));
+    EXPECT_EQ (search ("user"), std::vector<int> ({ 5, 6, 7 }));
+    EXPECT_EQ (search ("my"), std::vector<int> ({ 6 }));
+}
+
+TEST_F (PresetIndexTest, AllTermsMustMatch)
+{
+    EXPECT_EQ (search ("user bass"), std::vector<int> ({ 7, 5 }));
+    EXPECT_EQ (search ("factory bass"), std::vector<int> ({ 1, 2 }));
+    EXPECT_TRUE (search ("factory sub").empty());
+}
+
+TEST_F (PresetIndexTest, ShortTermsMatchOnlyBeginningOfWords)
+{
+    EXPECT_EQ (search ("s"), std::vector<int> ({ 4, 7, 5 }));
+    EXPECT_EQ (search ("fx"), std::vector<int> ({ 3 }));
+    // "ft" is in "Soft" and "Factory", but not at the beginning of a word
+    EXPECT_TRUE (search ("ft").empty());
+}
+
+TEST_F (PresetIndexTest, MaxResults)
+{
+    EXPECT_EQ (search ("bass", 2), std::vector<int> ({ 1, 2 }));
+    EXPECT_TRUE (search ("bass", 0).empty());
+}
+
+TEST_F (PresetIndexTest, Clear)
+{
+    presetIndex.clear();
+    EXPECT_EQ (presetIndex.size(), 0);
+    EXPECT_TRUE (search ("bass").empty());
+    EXPECT_EQ (presetIndex.add ("Bass", ""), 0);
+    EXPECT_EQ (search ("b"), std::vector<int> ({ 0 }));
+}
+
+TEST_F (PresetIndexTest, ManyPresets)
+{
+    presetIndex.clear();
+    for (int i = 0; i < 10000; i++)
+        presetIndex.add ("Preset" + std::to_string (i), "User/Folder" + std::to_string (i % 100));
+
+    EXPECT_EQ (presetIndex.size(), 10000);
+    EXPECT_EQ (search ("preset9999"), std::vector<int> ({ 9999 }));
+    EXPECT_EQ (search ("folder42 preset1042"), std::vector<int> ({ 1042 }));
+    EXPECT_EQ (search ("preset", 3), std::vector<int> ({ 0, 1, 2 }));
+}
+
+} // namespace onsen
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+   Preset Loader Test
+  ==============================================================================
+*/
+
+#include "../../src/services/PresetLoader.h"
+#include "../../src/services/TmpFileManager.h"
+#include <JuceHeader.h>
+#include <atomic>
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+//==============================================================================
+class PresetLoaderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        testDir.deleteRecursively();
+        testDir.createDirectory();
+    }
+
+    void TearDown() override
+    {
+        testDir.deleteRecursively();
+    }
+
+    // Pretends to decode a preset. The state has the file content as a property.
+    static juce::ValueTree decode (const juce::File& file, const juce::String& processorName)
+    {
+        ++numDecoded;
+        if (! file.existsAsFile())
+            return {};
+        juce::ValueTree state { juce::Identifier (processorName) };
+        state.setProperty (juce::Identifier ("content"), file.loadFileAsString(), nullptr);
+        return state;
+    }
+
+    static juce::String contentOf (const PresetLoader::DecodedPreset* decoded)
+    {
+        return decoded->state[juce::Identifier ("content")].toString();
+    }
+
+    static inline std::atomic<int> numDecoded { 0 };
+    const juce::File testDir { onsen::TmpFileManager::getTmpDir().getChildFile ("preset_loader_test") };
+    PresetLoader presetLoader { decode };
+};
+//==============================================================================
+
+TEST_F (PresetLoaderTest, NothingIsCachedBeforePrefetch)
+{
+    auto file = testDir.getChildFile ("A.oapreset");
+    file.replaceWithText ("A");
+    EXPECT_EQ (presetLoader.findCached (file), nullptr);
+}
+
+TEST_F (PresetLoaderTest, PrefetchDecodesInBackground)
+{
+    auto file = testDir.getChildFile ("A.oapreset");
+    file.replaceWithText ("A");
+
+    presetLoader.prefetch (file, "OS-251");
+    ASSERT_TRUE (presetLoader.waitUntilIdle (5000));
+
+    auto decoded = presetLoader.findCached (file);
+    ASSERT_NE (decoded, nullptr);
+    EXPECT_TRUE (decoded->state.hasType (juce::Identifier ("OS-251")));
+    EXPECT_EQ (contentOf (decoded), "A");
+}
+
+TEST_F (PresetLoaderTest, CachedPresetIsNotDecodedAgain)
+{
+    auto file = testDir.getChildFile ("A.oapreset");
+    file.replaceWithText ("A");
+
+    presetLoader.prefetch (file, "OS-251");
+    ASSERT_TRUE (presetLoader.waitUntilIdle (5000));
+    const int numDecodedBefore = numDecoded;
+
+    presetLoader.prefetch (file, "OS-251");
+    ASSERT_TRUE (presetLoader.waitUntilIdle (5000));
+    EXPECT_EQ (numDecoded.load(), numDecodedBefore);
+}
+
+TEST_F (PresetLoaderTest, FileThatCannotBeDecodedIsNotCached)
+{
+    auto file = testDir.getChildFile ("NotExist.oapreset");
+
+    presetLoader.prefetch (file, "OS-251");
+    ASSERT_TRUE (presetLoader.waitUntilIdle (5000));
+    EXPECT_EQ (presetLoader.findCached (file), nullptr);
+}
+
+TEST_F (PresetLoaderTest, ModifiedFileIsNotReturned)
+{
+    auto file = testDir.getChildFile ("A.oapreset");
+    file.replaceWithText ("A");
+
+    presetLoader.prefetch (file, "OS-251");
+    ASSERT_TRUE (presetLoader.waitUntilIdle (5000));
+    ASSERT_NE (presetLoader.findCached (file), nullptr);
+
+    // Edited by other tools
+    file.replaceWithText ("B");
+    file.setLastModificationTime (file.getLastModificationTime() + juce::RelativeTime::seconds (10.0));
+    EXPECT_EQ (presetLoader.findCached (file), nullptr);
+}
+
+TEST_F (PresetLoaderTest, Invalidate)
+{
+    auto a = testDir.getChildFile ("A.oapreset");
+    auto b = testDir.getChildFile ("B.oapreset");
+    a.replaceWithText ("A");
+    b.replaceWithText ("B");
+
+    presetLoader.prefetch (a, "OS-251");
+    presetLoader.prefetch (b, "OS-251");
+    ASSERT_TRUE (presetLoader.waitUntilIdle (5000));
+
+    presetLoader.invalidate (a);
+    EXPECT_EQ (presetLoader.findCached (a), nullptr);
+    ASSERT_NE (presetLoader.findCached (b), nullptr);
+    EXPECT_EQ (contentOf (presetLoader.findCached (b)), "B");
+
+    presetLoader.invalidate();
+    EXPECT_EQ (presetLoader.findCached (b), nullptr);
+}
+
+TEST_F (PresetLoaderTest, LeastRecentlyUsedPresetIsEvicted)
+{
+    juce::Array<juce::File> files;
+    for (int i = 0; i < 12; i++)
+    {
+        auto file = testDir.getChildFile ("Preset" + juce::String (i) + ".oapreset");
+        file.replaceWithText (juce::String (i));
+        files.add (file);
+        presetLoader.prefetch (file, "OS-251");
+        ASSERT_TRUE (presetLoader.waitUntilIdle (5000));
+    }
+
+    EXPECT_EQ (presetLoader.findCached (files.getFirst()), nullptr);
+    ASSERT_NE (presetLoader.findCached (files.getLast()), nullptr);
+    EXPECT_EQ (contentOf (presetLoader.findCached (files.getLast())), "11");
+}
+
+} // namespace onsen
@@ -278,6 +278,60 @@ TEST_F (PresetManagerTest, LoadPrevAndNext)
     EXPECT_EQ (stateXml->getChildByAttribute ("id", "attack")->getAttributeValue (1 /*value*/).toStdString(), "0.123");
 }
 
+TEST_F (PresetManagerTest, StepThroughPresetsWhilePrefetching)
+{
+    presetManager.scanPresets();
+    presetManager.loadPreset (presetManager.getDefaultPresetFile());
+    auto presets = presetManager.getPresets();
+
+    // Whether the preset was prefetched or not, the result should be the same
+    // as the one loaded directly.
+    for (int i = 1; i < presets.size(); i++)
+    {
+        // Odd ones may or may not be decoded yet
+        if (i % 2 == 0)
+            ASSERT_TRUE (presetManager.waitUntilPrefetched (5000));
+        presetManager.loadNext();
+        EXPECT_EQ (presetManager.getCurrentPresetFile(), presets[i]);
+        auto steppedState = processorState.copyState().createXml();
+
+        presetManager.loadPreset (presets[i]);
+        auto loadedState = processorState.copyState().createXml();
+        EXPECT_TRUE (steppedState->isEquivalentTo (loadedState.get(), false));
+    }
+
+    // Go back to the default preset
+    for (int i = presets.size() - 2; i >= 0; i--)
+    {
+        presetManager.loadPrev();
+        EXPECT_EQ (presetManager.getCurrentPresetFile(), presets[i]);
+    }
+    auto state = processorState.copyState().createXml();
+    EXPECT_EQ (state->getChildByAttribute ("id", "portamento")->getAttributeValue (1 /*value*/), "0.0");
+}
+
+TEST_F (PresetManagerTest, SavedPresetIsNotLoadedFromStaleCache)
+{
+    presetManager.scanPresets();
+    auto test0 = presetManager.getUserPresetDir().getChildFile ("Test0.oapreset");
+    presetManager.loadPreset (presetManager.getDefaultPresetFile());
+    presetManager.savePreset (test0);
+    presetManager.scanPresets();
+
+    // Let the preset manager prefetch Test0, so that it's cached when it's saved again
+    presetManager.loadPreset (presetManager.getDefaultPresetFile());
+    ASSERT_TRUE (presetManager.waitUntilPrefetched (5000));
+    presetManager.loadPreset (test0);
+    ASSERT_TRUE (presetManager.waitUntilPrefetched (5000));
+
+    auto statePtr = processorState.getState();
+    statePtr->getChild (1 /*attack*/).setProperty (juce::Identifier ("value"), "0.456", nullptr);
+    presetManager.savePreset (test0);
+    presetManager.loadPreset (presetManager.getDefaultPresetFile());
+    presetManager.loadPreset (test0);
+    EXPECT_EQ (statePtr->getChild (1 /*attack*/).getProperty (juce::Identifier ("value")).toString().toStdString(), "0.456");
+}
+
 TEST_F (PresetManagerTest, SavePreset)
 {
     presetManager.scanPresets();
@@ -306,6 +360,32 @@ TEST_F (PresetManagerTest, SavePreset)
     EXPECT_EQ (statePtr->getChild (1 /*attack*/).getProperty (juce::Identifier ("value")).toString().toStdString(), "0.456");
 }
 
+TEST_F (PresetManagerTest, SaveAndLoadChorusEnsemble)
+{
+    presetManager.scanPresets();
+    presetManager.loadPreset (presetManager.getDefaultPresetFile());
+    auto statePtr = processorState.getState();
+    const auto getEnsembleParam = [&]() {
+        return statePtr->getChildWithProperty (juce::Identifier ("id"), "chorusEnsemble");
+    };
+    const auto getEnsemble = [&]() {
+        return getEnsembleParam().getProperty (juce::Identifier ("value")).toString().toStdString();
+    };
+    ASSERT_EQ (getEnsemble(), "0.0");
+
+    // 5 taps instead of the default "off"
+    getEnsembleParam().setProperty (juce::Identifier ("value"), "0.5", nullptr);
+    auto newPresetFile = presetManager.getUserPresetDir().getChildFile ("Ensemble.oapreset");
+    presetManager.savePreset (newPresetFile);
+
+    // Every factory preset sets it, so it doesn't keep a stale value
+    presetManager.loadPreset (presetManager.getFactoryPresetDir().getChildFile ("Bass/Bass0.oapreset"));
+    EXPECT_EQ (getEnsemble(), "0.0");
+
+    presetManager.loadPreset (newPresetFile);
+    EXPECT_EQ (getEnsemble(), "0.5");
+}
+
 TEST_F (PresetManagerTest, SavePresetUsingPathWithoutExtension)
 {
     presetManager.scanPresets();
@@ -394,6 +474,85 @@ TEST_F (PresetManagerTest, TrackPresetsUsingRescan)
     EXPECT_EQ (presetManager.getPresets().size(), initialNumPresets);
 }
 
+TEST_F (PresetManagerTest, SearchPresets)
+{
+    presetManager.scanPresets();
+    auto factoryDir = presetManager.getFactoryPresetDir();
+
+    auto results = presetManager.searchPresets ("bass", 100);
+    ASSERT_EQ (results.size(), 4);
+    EXPECT_EQ (results[0], factoryDir.getChildFile ("Bass/Bass0.oapreset"));
+    EXPECT_EQ (presetManager.getPresetFolder (results[0]), "Factory/Bass");
+    EXPECT_EQ (presetManager.getPresetFolder (presetManager.getDefaultPresetFile()), "");
+    EXPECT_EQ (presetManager.searchPresets ("bass", 2).size(), 2);
+    EXPECT_TRUE (presetManager.searchPresets ("NotExist", 100).isEmpty());
+
+    // The index follows rescans
+    auto userPreset = presetManager.getUserPresetDir().getChildFile ("Deep Bass.oapreset");
+    presetManager.savePreset (userPreset);
+    presetManager.scanPresets();
+    results = presetManager.searchPresets ("deep", 100);
+    ASSERT_EQ (results.size(), 1);
+    EXPECT_EQ (results[0], userPreset);
+
+    userPreset.deleteFile();
+    presetManager.scanPresets();
+    EXPECT_TRUE (presetManager.searchPresets ("deep", 100).isEmpty());
+}
+
+TEST_F (PresetManagerTest, ApplyPresetFileChanges)
+{
+    using ChangeType = PresetDirectoryWatcher::Change::Type;
+    presetManager.scanPresets();
+    const int initialNumPresets = presetManager.getPresets().size();
+    int numListChanged = 0;
+    presetManager.onPresetListChanged = [&numListChanged] {
+        numListChanged++;
+    };
+
+    // Added by other tools
+    auto userPreset = presetManager.getUserPresetDir().getChildFile ("Synced.oapreset");
+    presetManager.savePreset (userPreset);
+    presetManager.applyPresetFileChanges ({ { ChangeType::added, userPreset } });
+    EXPECT_EQ (numListChanged, 1);
+    EXPECT_EQ (presetManager.getPresets().size(), initialNumPresets + 1);
+    EXPECT_EQ (presetManager.getPresets().getLast(), userPreset);
+    EXPECT_EQ (presetManager.searchPresets ("synced", 100).size(), 1);
+
+    // Already in the list
+    presetManager.applyPresetFileChanges ({ { ChangeType::added, userPreset } });
+    EXPECT_EQ (numListChanged, 1);
+    EXPECT_EQ (presetManager.getPresets().size(), initialNumPresets + 1);
+
+    // Modifications don't change the list
+    presetManager.applyPresetFileChanges ({ { ChangeType::modified, userPreset } });
+    EXPECT_EQ (numListChanged, 1);
+
+    // Sorted like scanPresets()
+    auto factoryPreset = presetManager.getFactoryPresetDir().getChildFile ("Bass/Bass00.oapreset");
+    presetManager.applyPresetFileChanges ({ { ChangeType::added, factoryPreset } });
+    EXPECT_EQ (presetManager.getFactoryPresets()[1], factoryPreset);
+
+    // Removed
+    presetManager.applyPresetFileChanges ({ { ChangeType::removed, userPreset }, { ChangeType::removed, factoryPreset } });
+    EXPECT_EQ (numListChanged, 3);
+    EXPECT_EQ (presetManager.getPresets().size(), initialNumPresets);
+    EXPECT_TRUE (presetManager.searchPresets ("synced", 100).isEmpty());
+
+    // Files outside of Factory and User folders are ignored
+    presetManager.applyPresetFileChanges ({ { ChangeType::added, testPresetDir.getChildFile ("Other.oapreset") } });
+    EXPECT_EQ (numListChanged, 3);
+}
+
+TEST_F (PresetManagerTest, WatchPresetDir)
+{
+    presetManager.scanPresets();
+    presetManager.startWatchingPresetDir();
+    presetManager.startWatchingPresetDir(); // Nothing happens
+    presetManager.stopWatchingPresetDir();
+    presetManager.stopWatchingPresetDir(); // Nothing happens
+}
+
 TEST_F (PresetManagerTest, RescanPresetAfterDeletingCurrentPreset)
 {
     presetManager.scanPresets();
@@ -446,6 +605,44 @@ TEST_F (PresetManagerTest, RescanPresetAfterDeletingFactoryPresetDir)
     EXPECT_EQ (presetManager.getPresets().size(), numPresets);
 }
 
+TEST_F (PresetManagerTest, RestoreOnlyMissingOrBrokenFactoryPresets)
+{
+    presetManager.scanPresets();
+    auto dir = presetManager.getFactoryPresetDir();
+    auto untouched = dir.getChildFile ("Bass/Bass0.oapreset");
+    auto missing = dir.getChildFile ("Bass/Bass1.oapreset");
+    auto broken = dir.getChildFile ("Bass/Bass2.oapreset");
+    auto overwritten = dir.getChildFile ("Bass/Bass3.oapreset");
+
+    // Make the modification time distinguishable from a rewrite
+    const auto oldTime = juce::Time::getCurrentTime() - juce::RelativeTime::hours (1.0);
+    untouched.setLastModificationTime (oldTime);
+    presetManager.scanPresets();
+    const auto untouchedTime = untouched.getLastModificationTime();
+
+    missing.deleteFile();
+    broken.replaceWithText ("Broken Preset XML");
+    presetManager.loadPreset (presetManager.getDefaultPresetFile());
+    presetManager.savePreset (overwritten);
+    const auto overwrittenContent = overwritten.loadFileAsString();
+
+    // Rescanning respects what the user did to the Factory folder
+    presetManager.scanPresets();
+    EXPECT_FALSE (missing.existsAsFile());
+    EXPECT_EQ (broken.loadFileAsString(), "Broken Preset XML");
+    EXPECT_EQ (presetManager.getFactoryPresets().size(), static_cast<int> (factoryPresets.size()) - 1);
+
+    // Restoring on request writes only what is missing or broken
+    presetManager.restoreFactoryPresets();
+    presetManager.scanPresets();
+    EXPECT_EQ (untouched.getLastModificationTime(), untouchedTime);
+    EXPECT_TRUE (missing.existsAsFile());
+    EXPECT_EQ (broken.getSize(), static_cast<juce::int64> (BinaryData::Bass2_oapresetSize));
+    // Valid presets are kept even if they are different from the factory ones
+    EXPECT_EQ (overwritten.loadFileAsString(), overwrittenContent);
+    EXPECT_EQ (presetManager.getFactoryPresets().size(), static_cast<int> (factoryPresets.size()));
+}
+
 TEST_F (PresetManagerTest, RescanPresetAfterDeletingUserPresetDir)
 {
     presetManager.scanPresets();
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+   Preset Manifest Test
+  ==============================================================================
+*/
+
+#include "../../src/services/PresetManifest.h"
+#include "../../src/services/TmpFileManager.h"
+#include <JuceHeader.h>
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+//==============================================================================
+class PresetManifestTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        testDir.deleteRecursively();
+        testDir.createDirectory();
+        file.create();
+        file.replaceWithText ("Preset");
+    }
+
+    void TearDown() override
+    {
+        testDir.deleteRecursively();
+    }
+
+    static juce::uint64 hashOf (const juce::String& text)
+    {
+        return PresetManifest::hash (text.toRawUTF8(), text.getNumBytesAsUTF8());
+    }
+
+    const juce::File testDir { onsen::TmpFileManager::getTmpDir().getChildFile ("preset_manifest_test") };
+    const juce::File file { testDir.getChildFile ("Factory/Bass/A.oapreset") };
+};
+//==============================================================================
+
+TEST_F (PresetManifestTest, Hash)
+{
+    // Test vectors of FNV-1a 64
+    EXPECT_EQ (hashOf (""), 0xcbf29ce484222325ULL);
+    EXPECT_EQ (hashOf ("a"), 0xaf63dc4c8601ec8cULL);
+    EXPECT_EQ (hashOf ("foobar"), 0x85944171f73967e8ULL);
+}
+
+TEST_F (PresetManifestTest, RecordedFileIsUntouched)
+{
+    PresetManifest manifest (testDir);
+    EXPECT_FALSE (manifest.isUntouched (file));
+    EXPECT_EQ (manifest.getRecordedHash (file), 0u);
+
+    manifest.record (file, hashOf ("Preset"));
+    EXPECT_TRUE (manifest.isUntouched (file));
+    EXPECT_EQ (manifest.getRecordedHash (file), hashOf ("Preset"));
+
+    // Modified
+    file.replaceWithText ("Modified");
+    EXPECT_FALSE (manifest.isUntouched (file));
+
+    // Removed
+    manifest.record (file, hashOf ("Modified"));
+    file.deleteFile();
+    EXPECT_FALSE (manifest.isUntouched (file));
+}
+
+TEST_F (PresetManifestTest, SaveAndLoad)
+{
+    {
+        PresetManifest manifest (testDir);
+        manifest.saveIfNeeded();
+        // Nothing is recorded
+        EXPECT_FALSE (manifest.getManifestFile().exists());
+
+        manifest.record (file, hashOf ("Preset"));
+        manifest.saveIfNeeded();
+        EXPECT_TRUE (manifest.getManifestFile().existsAsFile());
+    }
+
+    PresetManifest manifest (testDir);
+    EXPECT_TRUE (manifest.isUntouched (file));
+    EXPECT_EQ (manifest.getRecordedHash (file), hashOf ("Preset"));
+}
+
+TEST_F (PresetManifestTest, BrokenManifestIsIgnored)
+{
+    PresetManifest (testDir).getManifestFile().replaceWithText ("Broken\n1\t2\t3\tFactory/Bass/A.oapreset\n");
+    PresetManifest manifest (testDir);
+    EXPECT_FALSE (manifest.isUntouched (file));
+    EXPECT_EQ (manifest.getRecordedHash (file), 0u);
+}
+
+} // namespace onsen
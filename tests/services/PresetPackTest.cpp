@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+   Preset Pack Test
+  ==============================================================================
+*/
+
+#include "../../src/services/FactoryPresets.h"
+#include "../../src/services/PresetManager.h"
+#include "../../src/services/PresetPack.h"
+#include "../../src/services/TmpFileManager.h"
+#include <JuceHeader.h>
+#include <cstring>
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+//==============================================================================
+class PresetPackTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        testDir.deleteRecursively();
+        for (const auto& preset : factoryPresets)
+        {
+            auto file = testPresetDir.getChildFile ("Factory").getChildFile (preset.path);
+            file.create();
+            file.replaceWithData (preset.data, static_cast<size_t> (preset.size));
+            presetFiles.add (file);
+        }
+    }
+
+    void TearDown() override
+    {
+        testDir.deleteRecursively();
+    }
+
+    static void expectSameState (const juce::ValueTree& a, const juce::ValueTree& b)
+    {
+        ASSERT_EQ (a.getNumChildren(), b.getNumChildren());
+        for (int i = 0; i < a.getNumChildren(); i++)
+        {
+            EXPECT_EQ (a.getChild (i)["id"].toString(), b.getChild (i)["id"].toString());
+            EXPECT_EQ (static_cast<double> (a.getChild (i)["value"]), static_cast<double> (b.getChild (i)["value"]));
+        }
+    }
+
+    const juce::String processorName { "OS-251" };
+    const juce::File testDir { onsen::TmpFileManager::getTmpDir().getChildFile ("preset_pack_test") };
+    const juce::File testPresetDir { testDir.getChildFile ("presets") };
+    const juce::File packFile { testDir.getChildFile ("presets.oapack") };
+    juce::Array<juce::File> presetFiles;
+};
+//==============================================================================
+
+TEST_F (PresetPackTest, RoundTripWithOapreset)
+{
+    for (const auto& preset : factoryPresets)
+    {
+        auto originalXml = juce::parseXML (juce::String::fromUTF8 (preset.data, preset.size));
+        ASSERT_NE (originalXml, nullptr);
+
+        PresetBinaryFormat::PresetRecord record;
+        ASSERT_TRUE (PresetPack::presetXmlToRecord (originalXml.get(), processorName, record));
+        auto convertedXml = PresetPack::recordToPresetXml (record, processorName);
+        ASSERT_TRUE (PresetManager::validatePresetXml (convertedXml.get(), processorName));
+
+        EXPECT_EQ (convertedXml->getChildByName ("SavedByVersion")->getAllSubText(),
+                   originalXml->getChildByName ("SavedByVersion")->getAllSubText());
+        auto originalState = juce::ValueTree::fromXml (*originalXml->getChildByName ("State")->getChildByName (processorName));
+        auto convertedState = juce::ValueTree::fromXml (*convertedXml->getChildByName ("State")->getChildByName (processorName));
+        expectSameState (originalState, convertedState);
+
+        // Converting it again doesn't change anything
+        PresetBinaryFormat::PresetRecord recordAgain;
+        ASSERT_TRUE (PresetPack::presetXmlToRecord (convertedXml.get(), processorName, recordAgain));
+        EXPECT_EQ (std::memcmp (&record, &recordAgain, record.size()), 0);
+    }
+}
+
+TEST_F (PresetPackTest, InvalidPresetIsNotConverted)
+{
+    PresetBinaryFormat::PresetRecord record;
+    EXPECT_FALSE (PresetPack::presetXmlToRecord (nullptr, processorName, record));
+    auto xml = juce::parseXML ("<Preset><Gadget>OS-251</Gadget></Preset>");
+    EXPECT_FALSE (PresetPack::presetXmlToRecord (xml.get(), processorName, record));
+}
+
+TEST_F (PresetPackTest, WriteAndReadPack)
+{
+    // Invalid presets are skipped
+    auto brokenFile = testPresetDir.getChildFile ("User/Broken.oapreset");
+    brokenFile.create();
+    brokenFile.replaceWithText ("broken");
+    presetFiles.add (brokenFile);
+
+    ASSERT_TRUE (PresetPack::writePack (testPresetDir, presetFiles, packFile, processorName));
+    PresetPack pack (packFile);
+    ASSERT_TRUE (pack.isValid());
+    ASSERT_EQ (pack.getNumPresets(), static_cast<int> (factoryPresets.size()));
+    EXPECT_EQ (pack.findPreset ("User/Broken.oapreset"), -1);
+
+    for (const auto& preset : factoryPresets)
+    {
+        const int idx = pack.findPreset ("Factory/" + preset.path);
+        ASSERT_GE (idx, 0);
+        EXPECT_EQ (pack.getPresetPath (idx), "Factory/" + preset.path);
+
+        PresetBinaryFormat::PresetRecord record;
+        ASSERT_TRUE (pack.readPreset (idx, record));
+        auto originalXml = juce::parseXML (juce::String::fromUTF8 (preset.data, preset.size));
+        auto originalState = juce::ValueTree::fromXml (*originalXml->getChildByName ("State")->getChildByName (processorName));
+        expectSameState (originalState, PresetPack::recordToPresetState (record, processorName));
+    }
+}
+
+TEST_F (PresetPackTest, InvalidPackFile)
+{
+    PresetPack notExist (testDir.getChildFile ("NotExist.oapack"));
+    EXPECT_FALSE (notExist.isValid());
+    EXPECT_EQ (notExist.getNumPresets(), 0);
+    EXPECT_EQ (notExist.findPreset ("Default.oapreset"), -1);
+
+    testDir.createDirectory();
+    packFile.replaceWithText ("This is not a pack");
+    PresetPack broken (packFile);
+    EXPECT_FALSE (broken.isValid());
+    PresetBinaryFormat::PresetRecord record;
+    EXPECT_FALSE (broken.readPreset (0, record));
+}
+
+} // namespace onsen
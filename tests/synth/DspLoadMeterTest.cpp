@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+   DSP Load Meter Test
+
+  ==============================================================================
+*/
+
+#include "../../src/synth/DspLoadMeter.h"
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+//==============================================================================
+// DSP load meter
+
+TEST (DspLoadMeterTest, LoadIsRatioToDeadline)
+{
+    DspLoadMeter meter;
+    meter.setCurrentPlaybackSampleRate (48000.0);
+    // 480 samples are 10 ms
+    meter.addBlock (0.005, 480, 3);
+    EXPECT_FLOAT_EQ (meter.getLastLoad(), 0.5f);
+    EXPECT_FLOAT_EQ (meter.getLoad(), 0.5f);
+    EXPECT_EQ (meter.getNumActiveVoices(), 3);
+
+    meter.addBlock (0.02, 480, 4);
+    EXPECT_FLOAT_EQ (meter.getLastLoad(), 2.0f);
+    // Empty blocks are ignored
+    meter.addBlock (0.01, 0, 0);
+    EXPECT_FLOAT_EQ (meter.getLastLoad(), 2.0f);
+    EXPECT_EQ (meter.getNumActiveVoices(), 4);
+}
+
+TEST (DspLoadMeterTest, PeakIsKeptUntilPopped)
+{
+    DspLoadMeter meter;
+    meter.setCurrentPlaybackSampleRate (48000.0);
+    meter.addBlock (0.001, 480, 0);
+    meter.addBlock (0.008, 480, 0);
+    meter.addBlock (0.002, 480, 0);
+    EXPECT_FLOAT_EQ (meter.getLoad(), 0.2f);
+    EXPECT_FLOAT_EQ (meter.popPeakLoad(), 0.8f);
+    EXPECT_FLOAT_EQ (meter.popPeakLoad(), 0.0f);
+
+    meter.addBlock (0.003, 480, 0);
+    EXPECT_FLOAT_EQ (meter.popPeakLoad(), 0.3f);
+}
+
+TEST (DspLoadMeterTest, MeasureBlock)
+{
+    DspLoadMeter meter;
+    meter.setCurrentPlaybackSampleRate (48000.0);
+    meter.beginBlock();
+    meter.endBlock (480, 1);
+    EXPECT_GE (meter.getLastLoad(), 0.0f);
+    EXPECT_EQ (meter.getNumActiveVoices(), 1);
+}
+} // namespace onsen
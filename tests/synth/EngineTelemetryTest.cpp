@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+   Engine Telemetry Test
+
+  ==============================================================================
+*/
+
+#include "../../src/synth/EngineTelemetry.h"
+#include "../../src/synth/SynthEngine.h"
+#include "../dsp/util/AudioBufferMock.h"
+#include "../dsp/util/PositionInfoMock.h"
+#include "SynthParamsMock.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace onsen
+{
+//==============================================================================
+// SpscRing
+
+TEST (SpscRingTest, PushAndPop)
+{
+    SpscRing<int, 4> ring;
+    int val = -1;
+    EXPECT_FALSE (ring.pop (val));
+    for (int i = 0; i < 4; i++)
+        EXPECT_TRUE (ring.push (i));
+    // Full
+    EXPECT_FALSE (ring.push (4));
+    EXPECT_EQ (ring.size(), 4u);
+
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE (ring.pop (val));
+        EXPECT_EQ (val, i);
+    }
+    EXPECT_FALSE (ring.pop (val));
+    // Wraps around
+    EXPECT_TRUE (ring.push (5));
+    ASSERT_TRUE (ring.pop (val));
+    EXPECT_EQ (val, 5);
+}
+
+TEST (SpscRingTest, ProducerAndConsumerThreads)
+{
+    constexpr int numItems = 100000;
+    SpscRing<int, 64> ring;
+    std::thread producer ([&ring] {
+        for (int i = 0; i < numItems; i++)
+        {
+            while (! ring.push (i))
+                std::this_thread::yield();
+        }
+    });
+
+    int expected = 0;
+    while (expected < numItems)
+    {
+        int val;
+        if (! ring.pop (val))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        // Nothing is lost or reordered
+        ASSERT_EQ (val, expected);
+        expected++;
+    }
+    producer.join();
+}
+
+//==============================================================================
+// SynthEngine's stage timing
+
+TEST (EngineTelemetryTest, RecordBlocks)
+{
+    SynthParamsMockValues synthParamsMockValues;
+    auto synthParams = synthParamsMockValues.getSynthParams();
+    PositionInfoMock positionInfo;
+    Lfo lfo (synthParams->lfo(), &positionInfo);
+    auto voices = FancySynthVoice::buildVoices (SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo);
+    SynthEngine synth (synthParams.get(), &positionInfo, &lfo, voices);
+    AudioBufferMock audioBuffer (2, 256);
+    synth.setCurrentPlaybackSampleRate (48000.0);
+    synth.setNumberOfVoices (4);
+
+    TelemetryRing ring;
+    synth.getTelemetry().setRing (&ring);
+    synth.handleMidiEvent ({ MidiEvent::Type::noteOn, 0, 60, 100 });
+    synth.handleMidiEvent ({ MidiEvent::Type::noteOn, 0, 64, 100 });
+    synth.renderNextBlock (&audioBuffer, 0, 256);
+    synth.renderNextBlock (&audioBuffer, 0, 128);
+    EXPECT_EQ (synth.getNumActiveVoices(), 2);
+
+    BlockTelemetry record {};
+    if constexpr (! EngineTelemetry::isEnabled)
+    {
+        // Compiled out
+        EXPECT_FALSE (ring.pop (record));
+        return;
+    }
+
+    ASSERT_TRUE (ring.pop (record));
+    EXPECT_EQ (record.numSamples, 256);
+    EXPECT_EQ (record.numActiveVoices, 2);
+    EXPECT_EQ (record.numEvents, 2);
+    EXPECT_GT (record.stageCycles[BlockTelemetry::voices], 0u);
+    EXPECT_EQ (record.getTotalCycles(), std::uint64_t (record.stageCycles[0]) + record.stageCycles[1] + record.stageCycles[2] + record.stageCycles[3] + record.stageCycles[4]);
+
+    BlockTelemetry next {};
+    ASSERT_TRUE (ring.pop (next));
+    EXPECT_EQ (next.numSamples, 128);
+    EXPECT_EQ (next.numEvents, 0);
+    EXPECT_GE (next.startCycles, record.startCycles);
+    EXPECT_FALSE (ring.pop (next));
+    EXPECT_EQ (synth.getTelemetry().getNumDropped(), 0u);
+}
+} // namespace onsen
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+   MidiEvent Test
+
+  ==============================================================================
+*/
+
+#include "../../src/synth/MidiEvent.h"
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+//==============================================================================
+// MidiDecoder
+
+namespace
+{
+    MidiEvent decodeBytes (std::initializer_list<uint8_t> bytes, int sample = 0)
+    {
+        std::vector<uint8_t> data (bytes);
+        return MidiDecoder::decode (data.data(), static_cast<int> (data.size()), sample);
+    }
+} // namespace
+
+TEST (MidiDecoderTest, NoteOnAndNoteOff)
+{
+    auto event = decodeBytes ({ 0x90, 69, 100 }, 12);
+    EXPECT_EQ (event.type, MidiEvent::Type::noteOn);
+    EXPECT_EQ (event.sample, 12);
+    EXPECT_EQ (event.value, 69);
+    EXPECT_EQ (event.velocity, 100);
+
+    // Every channel is accepted
+    event = decodeBytes ({ 0x8f, 69, 64 });
+    EXPECT_EQ (event.type, MidiEvent::Type::noteOff);
+    EXPECT_EQ (event.value, 69);
+}
+
+TEST (MidiDecoderTest, NoteOnWithZeroVelocityIsNoteOff)
+{
+    auto event = decodeBytes ({ 0x91, 60, 0 });
+    EXPECT_EQ (event.type, MidiEvent::Type::noteOff);
+    EXPECT_EQ (event.value, 60);
+}
+
+TEST (MidiDecoderTest, PitchWheel)
+{
+    // LSB first
+    auto event = decodeBytes ({ 0xe0, 0x00, 0x40 });
+    EXPECT_EQ (event.type, MidiEvent::Type::pitchWheel);
+    EXPECT_EQ (event.value, 8192);
+    EXPECT_EQ (decodeBytes ({ 0xe0, 0x7f, 0x7f }).value, 16383);
+}
+
+TEST (MidiDecoderTest, Controllers)
+{
+    auto event = decodeBytes ({ 0xb0, 64, 127 });
+    EXPECT_EQ (event.type, MidiEvent::Type::sustainPedal);
+    EXPECT_EQ (event.value, 1);
+    event = decodeBytes ({ 0xb0, 64, 63 });
+    EXPECT_EQ (event.type, MidiEvent::Type::sustainPedal);
+    EXPECT_EQ (event.value, 0);
+    event = decodeBytes ({ 0xb0, 66, 64 });
+    EXPECT_EQ (event.type, MidiEvent::Type::sostenutoPedal);
+    EXPECT_EQ (event.value, 1);
+    EXPECT_EQ (decodeBytes ({ 0xb0, 123, 0 }).type, MidiEvent::Type::allNotesOff);
+    // Modulation wheel is not used
+    EXPECT_EQ (decodeBytes ({ 0xb0, 1, 64 }).type, MidiEvent::Type::none);
+}
+
+TEST (MidiDecoderTest, IgnoredMessages)
+{
+    EXPECT_EQ (decodeBytes ({ 0xc0, 5 }).type, MidiEvent::Type::none); // Program change
+    EXPECT_EQ (decodeBytes ({ 0xd0, 5 }).type, MidiEvent::Type::none); // Channel pressure
+    EXPECT_EQ (decodeBytes ({ 0xf0, 0x7e, 0xf7 }).type, MidiEvent::Type::none); // SysEx
+    EXPECT_EQ (decodeBytes ({ 0x90, 69 }).type, MidiEvent::Type::none); // Too short
+    EXPECT_EQ (MidiDecoder::decode (nullptr, 0, 0).type, MidiEvent::Type::none);
+}
+} // namespace onsen
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+   Quality Governor Test
+
+  ==============================================================================
+*/
+
+#include "../../src/synth/QualityGovernor.h"
+#include "../../src/synth/SynthEngine.h"
+#include "../dsp/util/AudioBufferMock.h"
+#include "../dsp/util/PositionInfoMock.h"
+#include "SynthParamsMock.h"
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+//==============================================================================
+// Quality governor
+
+class QualityGovernorTest : public ::testing::Test
+{
+protected:
+    QualityGovernorTest() : governor (makeConfig()) {}
+
+    static QualityGovernor::Config makeConfig()
+    {
+        QualityGovernor::Config config;
+        config.stepDownLoad = 0.8;
+        config.stepUpLoad = 0.5;
+        config.numBlocksToStepDown = 2;
+        config.numBlocksToStepUp = 10;
+        return config;
+    }
+
+    QualityLevel updateNTimes (flnum load, int n)
+    {
+        for (int i = 0; i < n - 1; i++)
+            governor.update (load);
+        return governor.update (load);
+    }
+
+    QualityGovernor governor;
+};
+
+TEST_F (QualityGovernorTest, StepDownUnderPressure)
+{
+    EXPECT_EQ (governor.update (0.9), QualityLevel::full);
+    EXPECT_EQ (governor.update (0.9), QualityLevel::coarseControl);
+    EXPECT_EQ (updateNTimes (0.9, 2), QualityLevel::cheapOscillators);
+    EXPECT_EQ (updateNTimes (1.5, 2), QualityLevel::noChorusInterpolation);
+    EXPECT_EQ (updateNTimes (1.5, 2), QualityLevel::stealReleaseTails);
+    // The lowest
+    EXPECT_EQ (updateNTimes (1.5, 10), QualityLevel::stealReleaseTails);
+}
+
+TEST_F (QualityGovernorTest, SingleSpikeDoesNotStepDown)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ (governor.update (0.9), QualityLevel::full);
+        EXPECT_EQ (governor.update (0.3), QualityLevel::full);
+    }
+}
+
+TEST_F (QualityGovernorTest, Hysteresis)
+{
+    updateNTimes (0.9, 4);
+    ASSERT_EQ (governor.getLevel(), QualityLevel::cheapOscillators);
+
+    // Between the thresholds nothing changes
+    EXPECT_EQ (updateNTimes (0.6, 100), QualityLevel::cheapOscillators);
+    // Headroom has to last
+    EXPECT_EQ (updateNTimes (0.3, 9), QualityLevel::cheapOscillators);
+    EXPECT_EQ (governor.update (0.3), QualityLevel::coarseControl);
+    // The count restarts after a block in the band
+    EXPECT_EQ (updateNTimes (0.3, 9), QualityLevel::coarseControl);
+    governor.update (0.6);
+    EXPECT_EQ (updateNTimes (0.3, 9), QualityLevel::coarseControl);
+    EXPECT_EQ (governor.update (0.3), QualityLevel::full);
+    EXPECT_EQ (updateNTimes (0.3, 100), QualityLevel::full);
+}
+
+TEST_F (QualityGovernorTest, LowestLevelAndReset)
+{
+    auto config = makeConfig();
+    config.lowestLevel = QualityLevel::cheapOscillators;
+    QualityGovernor limited (config);
+    for (int i = 0; i < 20; i++)
+        limited.update (2.0);
+    EXPECT_EQ (limited.getLevel(), QualityLevel::cheapOscillators);
+    limited.reset();
+    EXPECT_EQ (limited.getLevel(), QualityLevel::full);
+}
+
+//==============================================================================
+// SynthEngine's quality levels
+
+TEST (SynthEngineQualityTest, StealReleaseTails)
+{
+    SynthParamsMockValues synthParamsMockValues;
+    auto synthParams = synthParamsMockValues.getSynthParams();
+    // Long release
+    for (const auto& meta : synthParams->getParamMetaList())
+    {
+        if (meta.paramId == "release")
+            **meta.valuePtr = 1.0;
+    }
+    synthParams->parameterChanged();
+    PositionInfoMock positionInfo;
+    Lfo lfo (synthParams->lfo(), &positionInfo);
+    auto voices = FancySynthVoice::buildVoices (SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo);
+    SynthEngine synth (synthParams.get(), &positionInfo, &lfo, voices);
+    AudioBufferMock audioBuffer (2, 256);
+    synth.setCurrentPlaybackSampleRate (48000.0);
+    synth.setNumberOfVoices (8);
+
+    for (int i = 0; i < 6; i++)
+        synth.noteOn (60 + i, 100);
+    synth.renderNextBlock (&audioBuffer, 0, 256);
+    // 4 voices are released and 2 are held
+    for (int i = 0; i < 4; i++)
+        synth.noteOff (60 + i);
+    synth.renderNextBlock (&audioBuffer, 0, 256);
+    ASSERT_EQ (synth.getNumActiveVoices(), 6);
+
+    synth.setQualityLevel (QualityLevel::noChorusInterpolation);
+    synth.renderNextBlock (&audioBuffer, 0, 256);
+    EXPECT_EQ (synth.getNumActiveVoices(), 6);
+
+    // Held voices are kept
+    synth.setQualityLevel (QualityLevel::stealReleaseTails);
+    synth.renderNextBlock (&audioBuffer, 0, 256);
+    EXPECT_EQ (synth.getNumActiveVoices(), 4);
+    EXPECT_EQ (synth.getQualityLevel(), QualityLevel::stealReleaseTails);
+}
+} // namespace onsen
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+   Realtime Check Test
+
+  ==============================================================================
+*/
+
+#include "../../src/synth/RealtimeCheck.h"
+#include "../../src/synth/SynthEngine.h"
+#include "../dsp/util/AudioBufferMock.h"
+#include "../dsp/util/PositionInfoMock.h"
+#include "../util/AllocationCounter.h"
+#include "SynthParamsMock.h"
+#include <gtest/gtest.h>
+
+namespace onsen
+{
+#if OS251_REALTIME_CHECKS
+//==============================================================================
+// The checker itself. RealtimeGuard.cpp fails every other test on a violation.
+
+class RealtimeCheckTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        numReports = 0;
+        lastReport = {};
+        handlerToRestore = RealtimeCheck::detail::handler;
+        RealtimeCheck::setHandler (&recordReport);
+    }
+
+    void TearDown() override
+    {
+        RealtimeCheck::setHandler (handlerToRestore);
+    }
+
+    static void recordReport (const RealtimeCheck::Report& report)
+    {
+        numReports++;
+        lastReport = report;
+    }
+
+    // Calls operator new directly, which the optimizer can't remove like a new-expression
+    static void allocate()
+    {
+        static void* volatile allocated = nullptr;
+        allocated = ::operator new (16);
+        ::operator delete (allocated);
+    }
+
+    static inline int numReports = 0;
+    static inline RealtimeCheck::Report lastReport {};
+    RealtimeCheck::Handler handlerToRestore = nullptr;
+};
+
+TEST_F (RealtimeCheckTest, DetectAllocation)
+{
+    {
+        RealtimeCheck::AudioCallbackScope audioCallback ("allocating");
+        EXPECT_TRUE (RealtimeCheck::isInAudioCallback());
+        allocate();
+    }
+    EXPECT_FALSE (RealtimeCheck::isInAudioCallback());
+    ASSERT_EQ (numReports, 1);
+    EXPECT_STREQ (lastReport.scopeName, "allocating");
+    EXPECT_GE (lastReport.counts[RealtimeCheck::allocation], 1);
+    EXPECT_GE (lastReport.counts[RealtimeCheck::deallocation], 1);
+}
+
+TEST_F (RealtimeCheckTest, CountSameAllocationsAsBenchmarks)
+{
+    const auto numAllocationsBefore = AllocationCounter::getNumAllocations();
+    {
+        RealtimeCheck::AudioCallbackScope audioCallback ("allocating");
+        allocate();
+    }
+    ASSERT_EQ (numReports, 1);
+    EXPECT_EQ (static_cast<int> (AllocationCounter::getNumAllocations() - numAllocationsBefore),
+               lastReport.counts[RealtimeCheck::allocation]);
+}
+
+TEST_F (RealtimeCheckTest, NestedScopesReportOnce)
+{
+    {
+        RealtimeCheck::AudioCallbackScope outer ("outer");
+        {
+            RealtimeCheck::AudioCallbackScope inner ("inner");
+            allocate();
+        }
+        EXPECT_EQ (numReports, 0);
+    }
+    ASSERT_EQ (numReports, 1);
+    EXPECT_STREQ (lastReport.scopeName, "outer");
+}
+
+TEST_F (RealtimeCheckTest, AllowAllocationInNonRealtimeScope)
+{
+    {
+        RealtimeCheck::AudioCallbackScope audioCallback ("logging");
+        RealtimeCheck::NonRealtimeScope nonRealtime;
+        EXPECT_FALSE (RealtimeCheck::isInAudioCallback());
+        allocate();
+    }
+    EXPECT_EQ (numReports, 0);
+}
+
+TEST_F (RealtimeCheckTest, NoCheckOutsideScope)
+{
+    allocate();
+    EXPECT_EQ (numReports, 0);
+}
+
+//==============================================================================
+// SynthEngine with FancySynthVoice, which the other tests mostly replace with mocks
+
+TEST_F (RealtimeCheckTest, SynthEngineIsRealtimeSafe)
+{
+    SynthParamsMockValues synthParamsMockValues;
+    auto synthParams = synthParamsMockValues.getSynthParams();
+    for (const auto& meta : synthParams->getParamMetaList())
+    {
+        if (meta.paramId == "chorusOn" || meta.paramId == "release")
+            **meta.valuePtr = 1.0;
+    }
+    synthParams->parameterChanged();
+    PositionInfoMock positionInfo;
+    Lfo lfo (synthParams->lfo(), &positionInfo);
+    auto voices = FancySynthVoice::buildVoices (SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo);
+    SynthEngine synth (synthParams.get(), &positionInfo, &lfo, voices);
+    AudioBufferMock audioBuffer (2, 512);
+    synth.setCurrentPlaybackSampleRate (48000.0);
+    synth.setNumberOfVoices (8);
+
+    const auto render = [&] (int startSample, int numSamples) {
+        for (int ch = 0; ch < 2; ch++)
+            std::fill_n (audioBuffer.getWritePointer (ch), 512, 0.0f);
+        synth.renderNextBlock (&audioBuffer, startSample, numSamples);
+    };
+
+    for (int i = 0; i < 10; i++)
+        synth.handleMidiEvent ({ MidiEvent::Type::noteOn, 0, 48 + i * 3, 100 });
+    render (0, 512);
+    synth.handleMidiEvent ({ MidiEvent::Type::pitchWheel, 0, 12000, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::sustainPedal, 0, 127, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::noteOff, 0, 48, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::sostenutoPedal, 0, 127, 0 });
+    render (100, 37);
+    synth.handleMidiEvent ({ MidiEvent::Type::sustainPedal, 0, 0, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::sostenutoPedal, 0, 0, 0 });
+    for (auto level : { QualityLevel::cheapOscillators, QualityLevel::lowest, QualityLevel::full })
+    {
+        synth.setQualityLevel (level);
+        render (0, 512);
+    }
+    synth.handleMidiEvent ({ MidiEvent::Type::allNotesOff, 0, 0, 0 });
+    // Release tails, the chorus' tail and then silence
+    for (int i = 0; i < 200; i++)
+        render (0, 512);
+
+    EXPECT_EQ (numReports, 0) << lastReport.scopeName;
+}
+
+TEST_F (RealtimeCheckTest, ReconfigureWithoutAllocation)
+{
+    SynthParamsMockValues synthParamsMockValues;
+    auto synthParams = synthParamsMockValues.getSynthParams();
+    PositionInfoMock positionInfo;
+    Lfo lfo (synthParams->lfo(), &positionInfo);
+    auto voices = FancySynthVoice::buildVoices (SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo);
+    SynthEngine synth (synthParams.get(), &positionInfo, &lfo, voices);
+
+    {
+        // Hosts switch the rate and the block size on the fly, e.g. for an offline bounce
+        RealtimeCheck::AudioCallbackScope audioCallback ("reconfiguration");
+        for (const double sampleRate : { 96000.0, 192000.0, 44100.0 })
+            synth.setCurrentPlaybackSampleRate (sampleRate);
+        lfo.setSamplesPerBlock (SynthEngine::getProcessingQuantum());
+    }
+    EXPECT_EQ (numReports, 0) << lastReport.counts[RealtimeCheck::allocation] << " allocation(s)";
+}
+#endif
+} // namespace onsen
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+   Realtime Guard
+
+  ==============================================================================
+*/
+
+/*
+Fails the running test when SynthEngine allocates or locks a mutex on the
+audio path (see src/synth/RealtimeCheck.h).
+
+Allocations are caught by tests/util/AllocationCounter.cpp, which the
+benchmarks share. With glibc, pthread_mutex_lock is interposed here too.
+*/
+
+#include "../../src/synth/RealtimeCheck.h"
+#include <gtest/gtest.h>
+
+#if OS251_REALTIME_CHECKS
+
+    #if defined(__GLIBC__)
+        #include <dlfcn.h>
+        #include <pthread.h>
+    #endif
+
+namespace onsen
+{
+namespace
+{
+    void reportViolation (const RealtimeCheck::Report& report)
+    {
+        ADD_FAILURE() << report.scopeName << " isn't realtime safe: "
+                      << report.counts[RealtimeCheck::allocation] << " allocation(s), "
+                      << report.counts[RealtimeCheck::deallocation] << " deallocation(s), "
+                      << report.counts[RealtimeCheck::lock] << " lock(s)";
+    }
+
+    // Before main(), so before any test starts an audio thread
+    const bool isHandlerSet = (RealtimeCheck::setHandler (&reportViolation), true);
+} // namespace
+} // namespace onsen
+
+//==============================================================================
+    #if defined(__GLIBC__)
+extern "C"
+{
+    int pthread_mutex_lock (pthread_mutex_t* mutex)
+    {
+        using LockFunc = int (*) (pthread_mutex_t*);
+        // Constant-initialized, so it has no guard variable which would lock a mutex
+        static LockFunc next = nullptr;
+        if (next == nullptr)
+            next = reinterpret_cast<LockFunc> (dlsym (RTLD_NEXT, "pthread_mutex_lock"));
+        onsen::RealtimeCheck::noteViolation (onsen::RealtimeCheck::lock);
+        return next (mutex);
+    }
+}
+    #endif
+
+#endif
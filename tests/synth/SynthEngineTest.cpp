@@ -7,6 +7,7 @@
 */
 
 #include "../../src/synth/SynthEngine.h"
+#include "../dsp/util/AudioBufferMock.h"
 #include "../dsp/util/PositionInfoMock.h"
 #include "SynthParamsMock.h"
 #include "SynthVoiceMock.h"
@@ -201,6 +202,25 @@ TEST_F (SynthEngineTest, AllNotesOff)
     ASSERT_EQ (logs[2], "stopNote: 2 1");
 }
 
+TEST_F (SynthEngineTest, Reset)
+{
+    synth.setNumberOfVoices (2);
+    synth.noteOn (60, 100);
+    logs.clear();
+
+    // Every voice is reset, including the ones beyond the number of voices
+    synth.reset();
+    ASSERT_EQ (logs.size(), voices.size());
+    for (size_t i = 0; i < voices.size(); i++)
+        ASSERT_EQ (logs[i], "reset: " + std::to_string (i));
+
+    // The voice which played the note is free again
+    logs.clear();
+    synth.noteOn (62, 100);
+    ASSERT_EQ (logs.size(), 1);
+    ASSERT_EQ (logs[0], "startNote: 0 62 0.79 8192");
+}
+
 TEST_F (SynthEngineTest, SetUnisonOn)
 {
     synth.setNumberOfVoices (3);
@@ -451,6 +471,124 @@ TEST_F (SynthEngineTest, SustainAndSostenutoPedalAtTheSameTime2)
     ASSERT_EQ (logs[3], "stopNote: 0 1");
 }
 
+TEST_F (SynthEngineTest, HandleMidiEvent)
+{
+    synth.setNumberOfVoices (1);
+    synth.handleMidiEvent ({ MidiEvent::Type::pitchWheel, 0, 0, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::noteOn, 0, 69, 127 });
+    synth.handleMidiEvent ({ MidiEvent::Type::sustainPedal, 0, 1, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::noteOff, 0, 69, 0 });
+    synth.handleMidiEvent ({ MidiEvent::Type::none, 0, 0, 0 });
+    // The note is held by the sustain pedal
+    ASSERT_EQ (logs.size(), 2);
+    ASSERT_EQ (logs[0], "setPitchWheel: 0 0");
+    ASSERT_EQ (logs[1], "startNote: 0 69 1.00 0");
+    synth.handleMidiEvent ({ MidiEvent::Type::sustainPedal, 0, 0, 0 });
+    ASSERT_EQ (logs.size(), 3);
+    ASSERT_EQ (logs[2], "stopNote: 0 1");
+}
+
+TEST_F (SynthEngineTest, SkipEffectsForSilence)
+{
+    synth.setCurrentPlaybackSampleRate (sampleRate);
+    AudioBufferMock audioBuffer { 2, static_cast<size_t> (samplesPerBlock) };
+
+    // Below the threshold, so it's cleared instead of processed
+    for (int ch = 0; ch < 2; ch++)
+        std::fill_n (audioBuffer.getWritePointer (ch), samplesPerBlock, SILENCE_THRESHOLD * 0.5f);
+    synth.renderNextBlock (&audioBuffer, 0, samplesPerBlock);
+    EXPECT_FLOAT_EQ (audioBuffer.getSample (0, 0), 0.0);
+    EXPECT_FLOAT_EQ (audioBuffer.getSample (1, samplesPerBlock - 1), 0.0);
+
+    // Audible input goes through the effects
+    std::fill_n (audioBuffer.getWritePointer (0), samplesPerBlock, 0.5f);
+    std::fill_n (audioBuffer.getWritePointer (1), samplesPerBlock, 0.5f);
+    synth.renderNextBlock (&audioBuffer, 0, samplesPerBlock);
+    EXPECT_NE (audioBuffer.getSample (0, samplesPerBlock - 1), 0.0);
+    EXPECT_NE (audioBuffer.getSample (0, samplesPerBlock - 1), 0.5);
+}
+
+TEST_F (SynthEngineTest, TailLength)
+{
+    const double release = synthParams->envelope()->getRelease();
+    EXPECT_DOUBLE_EQ (synth.getTailLengthSeconds(), release);
+
+    // The chorus' feedback makes the tail longer
+    for (const auto& meta : synthParams->getParamMetaList())
+    {
+        if (meta.paramId == "chorusOn")
+            **meta.valuePtr = 1.0;
+    }
+    synthParams->parameterChanged();
+    EXPECT_GT (synth.getTailLengthSeconds(), release);
+}
+
+//==============================================================================
+// Host block sizes
+
+class SynthEngineBlockSizeTest : public ::testing::Test
+{
+protected:
+    struct Engine
+    {
+        Engine()
+            : synthParams (synthParamsMockValues.getSynthParams()),
+              lfo (synthParams->lfo(), &positionInfo),
+              voices (FancySynthVoice::buildVoices (SynthEngine::getMaxNumVoices(), synthParams.get(), &lfo)),
+              synth (synthParams.get(), &positionInfo, &lfo, voices)
+        {
+            synthParams->parameterChanged();
+            synth.setCurrentPlaybackSampleRate (48000.0);
+            synth.setNumberOfVoices (4);
+            synth.noteOn (60, 100);
+            synth.noteOn (67, 100);
+        }
+
+        SynthParamsMockValues synthParamsMockValues;
+        std::shared_ptr<SynthParams> synthParams;
+        PositionInfoMock positionInfo;
+        Lfo lfo;
+        std::vector<std::shared_ptr<ISynthVoice>> voices;
+        SynthEngine synth;
+    };
+
+    // Voices get random phase offsets, so they're seeded to get the same engines
+    static std::unique_ptr<Engine> makeEngine()
+    {
+        std::srand (1);
+        return std::make_unique<Engine>();
+    }
+};
+
+TEST_F (SynthEngineBlockSizeTest, RenderBlockLargerThanAnyAnnounced)
+{
+    // Rendered in quanta, so the LFO's buffer isn't overrun
+    constexpr int numSamples = 8192;
+    auto engine = makeEngine();
+    AudioBufferMock audioBuffer { 2, numSamples };
+    engine->synth.renderNextBlock (&audioBuffer, 0, numSamples);
+    EXPECT_NE (audioBuffer.getSample (0, numSamples - 1), 0.0);
+}
+
+TEST_F (SynthEngineBlockSizeTest, SameOutputForQuantumAlignedBlocks)
+{
+    constexpr int quantum = SynthEngine::getProcessingQuantum();
+    constexpr int numSamples = quantum * 10;
+    auto engine = makeEngine();
+    AudioBufferMock wholeBlock { 2, numSamples };
+    engine->synth.renderNextBlock (&wholeBlock, 0, numSamples);
+    ASSERT_NE (wholeBlock.getSample (0, numSamples - 1), 0.0);
+
+    // Sub-blocks in one host block, like the ones split at MIDI events
+    auto other = makeEngine();
+    AudioBufferMock splitBlock { 2, numSamples };
+    for (int pos = 0; pos < numSamples; pos += quantum * 2)
+        other->synth.renderNextBlock (&splitBlock, pos, quantum * 2);
+
+    for (int i = 0; i < numSamples; i++)
+        ASSERT_FLOAT_EQ (splitBlock.getSample (0, i), wholeBlock.getSample (0, i)) << i;
+}
+
 // Assertion tests
 // They don't pass on GitHub Actions. So I skip them for now.
 // This PR might be related https://github.com/google/googletest/issues/234 .
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "../../src/synth/RealtimeCheck.h"
 #include "../../src/synth/SynthVoice.h"
 #include <iomanip>
 #include <ios>
@@ -16,6 +17,7 @@
 namespace onsen
 {
 //==============================================================================
+// Logging allocates, so it's excluded from the realtime checks of SynthEngine
 class SynthVoiceMock : public ISynthVoice
 {
     using flnum = float;
@@ -38,6 +40,7 @@ public:
     void setCurrentPlaybackSampleRate (const double newRate) override {};
     void startNote (int midiNoteNumber, flnum velocity, int currentPitchWheelPosition) override
     {
+        RealtimeCheck::NonRealtimeScope nonRealtime;
         std::stringstream ss;
         ss << std::fixed << std::setprecision (2);
         ss << "startNote: " << voiceId << " " << midiNoteNumber << " " << velocity << " " << currentPitchWheelPosition;
@@ -45,25 +48,55 @@ public:
     }
     void stopNote (flnum /*velocity*/, bool allowTailOff) override
     {
+        RealtimeCheck::NonRealtimeScope nonRealtime;
         std::stringstream ss;
         ss << "stopNote: " << voiceId << " " << allowTailOff;
         logs.push_back (ss.str());
     }
     void setPitchWheel (int newPitchWheelValue) override
     {
+        RealtimeCheck::NonRealtimeScope nonRealtime;
         std::stringstream ss;
         ss << "setPitchWheel: " << voiceId << " " << newPitchWheelValue;
         logs.push_back (ss.str());
     }
-    void renderNextBlock (IAudioBuffer* outputBuffer, int startSample, int numSamples) override {}
+    void renderNextBlock (IAudioBuffer* outputBuffer, int startSample, int numSamples) override
+    {
+        if (! logsRenderNextBlock)
+            return;
+        RealtimeCheck::NonRealtimeScope nonRealtime;
+        std::stringstream ss;
+        ss << "renderNextBlock: " << voiceId << " " << startSample << " " << numSamples;
+        logs.push_back (ss.str());
+    }
     void addPhaseOffset (flnum offset) override {}
     void setDetune (flnum val) override {}
+    bool isActive() override { return false; }
+    flnum getAmplitude() override { return 0.0; }
+    void cutOff() override
+    {
+        RealtimeCheck::NonRealtimeScope nonRealtime;
+        std::stringstream ss;
+        ss << "cutOff: " << voiceId;
+        logs.push_back (ss.str());
+    }
+    void reset() override
+    {
+        RealtimeCheck::NonRealtimeScope nonRealtime;
+        std::stringstream ss;
+        ss << "reset: " << voiceId;
+        logs.push_back (ss.str());
+    }
+    void setUseCheapKernels (bool val) override {}
 
     void setVoiceId (int id) { voiceId = id; }
     int getVoiceId() { return voiceId; }
+    // Rendering is not logged by default because it's called for every voice
+    void setLogsRenderNextBlock (bool val) { logsRenderNextBlock = val; }
 
 private:
     int voiceId;
+    bool logsRenderNextBlock = false;
     std::vector<std::string>& logs;
 };
 } // namespace onsen
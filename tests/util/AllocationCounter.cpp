@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+   Allocation Counter
+
+  ==============================================================================
+*/
+
+#include "AllocationCounter.h"
+#include "../../src/synth/RealtimeCheck.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+// Constant-initialized, so it's ready for allocations before main()
+std::atomic<size_t> numAllocations { 0 };
+
+void noteAllocation()
+{
+    numAllocations.fetch_add (1, std::memory_order_relaxed);
+    onsen::RealtimeCheck::noteViolation (onsen::RealtimeCheck::allocation);
+}
+
+void noteDeallocation (void* ptr)
+{
+    if (ptr != nullptr)
+        onsen::RealtimeCheck::noteViolation (onsen::RealtimeCheck::deallocation);
+}
+} // namespace
+
+//==============================================================================
+#if defined(__GLIBC__)
+extern "C"
+{
+    void* __libc_malloc (size_t size);
+    void* __libc_calloc (size_t num, size_t size);
+    void* __libc_realloc (void* ptr, size_t size);
+    void* __libc_memalign (size_t alignment, size_t size);
+    void __libc_free (void* ptr);
+
+    void* malloc (size_t size)
+    {
+        noteAllocation();
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t num, size_t size)
+    {
+        noteAllocation();
+        return __libc_calloc (num, size);
+    }
+
+    void* realloc (void* ptr, size_t size)
+    {
+        noteAllocation();
+        return __libc_realloc (ptr, size);
+    }
+
+    void* memalign (size_t alignment, size_t size)
+    {
+        noteAllocation();
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size)
+    {
+        noteAllocation();
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** ptr, size_t alignment, size_t size)
+    {
+        noteAllocation();
+        *ptr = __libc_memalign (alignment, size);
+        return *ptr != nullptr ? 0 : ENOMEM;
+    }
+
+    void free (void* ptr)
+    {
+        noteDeallocation (ptr);
+        __libc_free (ptr);
+    }
+}
+#else
+// The nothrow and aligned versions are not replaced. The nothrow versions call these ones.
+void* operator new (std::size_t size)
+{
+    noteAllocation();
+    if (auto* ptr = std::malloc (size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    return operator new (size);
+}
+
+void operator delete (void* ptr) noexcept
+{
+    noteDeallocation (ptr);
+    std::free (ptr);
+}
+
+void operator delete[] (void* ptr) noexcept
+{
+    operator delete (ptr);
+}
+
+void operator delete (void* ptr, std::size_t) noexcept
+{
+    operator delete (ptr);
+}
+
+void operator delete[] (void* ptr, std::size_t) noexcept
+{
+    operator delete (ptr);
+}
+#endif
+
+namespace onsen
+{
+//==============================================================================
+size_t AllocationCounter::getNumAllocations()
+{
+    return numAllocations.load (std::memory_order_relaxed);
+}
+} // namespace onsen
@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+   Allocation Counter
+
+  ==============================================================================
+*/
+
+/*
+Replaces the allocation functions of a test or benchmark executable, so that
+both agree on what counts as an allocation.
+
+With glibc, malloc and friends are interposed, which also catches operator new,
+std::function, std::string and exceptions. Elsewhere only the global operator
+new and delete are replaced.
+
+Every allocation and deallocation is also passed to
+RealtimeCheck::noteViolation(), which does nothing unless OS251_REALTIME_CHECKS
+is on.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace onsen
+{
+namespace AllocationCounter
+{
+    // The number of allocations since the program started. It's thread-safe.
+    size_t getNumAllocations();
+} // namespace AllocationCounter
+} // namespace onsen